@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * Bounded lock-free queue for multiple producers and multiple consumers
+ *
+ * The queue uses a ring buffer of cells with sequence numbers, such that producers and consumers only synchronize via
+ * atomic operations on the cell they claimed. The capacity is rounded up to the next power of two.
+ *
+ * @tparam T Type of the queued values, needs to be default constructible and copy assignable
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @param capacity Minimum number of values the queue can hold
+     */
+    explicit BoundedQueue(std::size_t capacity)
+      : capacity_(std::bit_ceil(capacity < 2 ? std::size_t(2) : capacity)), mask_(capacity_ - 1),
+        cells_(std::make_unique<Cell[]>(capacity_)), enqueue_pos_(0), dequeue_pos_(0) {
+        for (std::size_t n = 0; n < capacity_; ++n) {
+            cells_[n].sequence.store(n, std::memory_order_relaxed);
+        }
+    }
+
+    /** Return the number of values the queue can hold */
+    std::size_t Capacity() const { return capacity_; }
+
+    /**
+     * Try to append a value to the queue
+     *
+     * @param value Value to append
+     * @retval true If the value was appended
+     * @retval false If the queue is full
+     */
+    bool TryPush(const T& value) {
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = cells_[pos & mask_];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                // Cell is free, try to claim it
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                // Cell still occupied from previous round, queue is full
+                return false;
+            }
+            else {
+                // Another producer claimed the cell
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Try to remove the first value from the queue
+     *
+     * @param value Reference to which the removed value is assigned
+     * @retval true If a value was removed
+     * @retval false If the queue is empty
+     */
+    bool TryPop(T& value) {
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = cells_[pos & mask_];
+            const auto sequence = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                // Cell is filled, try to claim it
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                // Cell not filled yet, queue is empty
+                return false;
+            }
+            else {
+                // Another consumer claimed the cell
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::size_t capacity_;
+    std::size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+
+    // Separate cache lines for producers and consumers
+    alignas(64) std::atomic<std::size_t> enqueue_pos_;
+    alignas(64) std::atomic<std::size_t> dequeue_pos_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
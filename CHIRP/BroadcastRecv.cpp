@@ -1,11 +1,87 @@
 #include "BroadcastRecv.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#endif
+
 #include "CHIRP/protocol_info.hpp"
 
 using namespace cnstln::CHIRP;
 
 constexpr std::size_t MESSAGE_BUFFER = 1024;
 
+/** Delay before the continuous receive is re-armed after a failed receive */
+constexpr std::chrono::milliseconds RECEIVE_ERROR_BACKOFF {10};
+
+namespace {
+    /** Convert IPv4-mapped IPv6 addresses received on a dual-stack socket back to IPv4 addresses */
+    asio::ip::address normalize_address(const asio::ip::address& address) {
+        if (address.is_v6() && address.to_v6().is_v4_mapped()) {
+            return asio::ip::make_address_v4(asio::ip::v4_mapped, address.to_v6());
+        }
+        return address;
+    }
+} // namespace
+
+#if defined(__linux__)
+/** Maximum number of messages received with a single recvmmsg call */
+constexpr std::size_t RECVMMSG_BATCH = 64;
+
+/** Offset of the UDP payload in packets seen by a socket filter on a UDP socket */
+constexpr std::uint32_t FILTER_PAYLOAD_OFFSET = 8;
+
+/** Number of filter instructions to compare the group ID */
+constexpr std::size_t FILTER_GROUP_INSTRUCTIONS = 8;
+
+/** Maximum number of groups in a socket filter, limited by the 8-bit jump offsets */
+constexpr std::size_t FILTER_MAX_GROUPS = 31;
+
+/** Buffer for the control message carrying the drop counter of a received message */
+struct alignas(cmsghdr) ControlBuffer : std::array<std::uint8_t, CMSG_SPACE(sizeof(std::uint32_t))> {};
+#endif
+
+struct BroadcastRecv::AsyncRecvState {
+    /** Mutex held while executing the callback or modifying the state, recursive to allow stopping from the callback */
+    std::recursive_mutex mutex;
+
+    /** Receiver owning the socket, nullptr once the receiver is destroyed */
+    BroadcastRecv* receiver;
+
+    /** Callback executed for every received message, empty when receiving batches */
+    AsyncRecvCallback callback;
+
+    /** Callback executed for every received batch of messages, empty when receiving single messages */
+    AsyncRecvBatchCallback batch_callback;
+
+    /** Whether the continuous receive has been stopped */
+    bool stopped;
+
+    /** Reused buffer for the received message */
+    BroadcastMessage message;
+
+    /** Endpoint of the sender of the received message */
+    asio::ip::udp::endpoint sender_endpoint;
+
+    /** Reused buffer for received batches */
+    std::vector<BatchedBroadcastMessage> batch;
+
+    /** Timer delaying the next receive after an error, created on the first error */
+    std::unique_ptr<asio::steady_timer> backoff_timer;
+};
+
 std::string BroadcastMessage::content_to_string() const {
     std::string ret;
     ret.resize(content.size());
@@ -15,17 +91,49 @@ std::string BroadcastMessage::content_to_string() const {
     return ret;
 }
 
-BroadcastRecv::BroadcastRecv(asio::ip::address any_address)
-  : io_context_(), endpoint_(std::move(any_address), asio::ip::port_type(CHIRP_PORT)),
-    socket_(io_context_, endpoint_.protocol()) {
+BroadcastRecv::BroadcastRecv(std::unique_ptr<asio::io_context> own_io_context, asio::io_context* external_io_context,
+                             asio::ip::address any_address, const SocketOptions& socket_options)
+  : own_io_context_(std::move(own_io_context)),
+    io_context_(external_io_context != nullptr ? *external_io_context : *own_io_context_),
+    endpoint_(std::move(any_address), asio::ip::port_type(CHIRP_PORT)), socket_(io_context_, endpoint_.protocol()) {
     // Set reuseable address socket option
     socket_.set_option(asio::socket_base::reuse_address(true));
+    // IPv6 any address also receives IPv4 broadcasts, such that a single socket serves both families
+    if (endpoint_.address().is_v6() && endpoint_.address().is_unspecified()) {
+        // Not supported on all platforms, then only IPv6 is received
+        asio::error_code error {};
+        socket_.set_option(asio::ip::v6_only(false), error);
+    }
+    socket_options.Apply(socket_);
+#if defined(__linux__)
+    // Report number of dropped messages with every received message, ignore if not supported
+    const int rxq_ovfl = 1;
+    ::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_RXQ_OVFL, &rxq_ovfl, sizeof(rxq_ovfl));
+#endif
     // Bind socket on receiving side
     socket_.bind(endpoint_);
 }
 
-BroadcastRecv::BroadcastRecv(std::string_view any_ip)
-  : BroadcastRecv(asio::ip::make_address(any_ip)) {}
+BroadcastRecv::BroadcastRecv(asio::ip::address any_address, const SocketOptions& socket_options)
+  : BroadcastRecv(std::make_unique<asio::io_context>(), nullptr, std::move(any_address), socket_options) {}
+
+BroadcastRecv::BroadcastRecv(std::string_view any_ip, const SocketOptions& socket_options)
+  : BroadcastRecv(asio::ip::make_address(any_ip), socket_options) {}
+
+BroadcastRecv::BroadcastRecv(asio::io_context& io_context, asio::ip::address any_address, const SocketOptions& socket_options)
+  : BroadcastRecv(nullptr, &io_context, std::move(any_address), socket_options) {}
+
+BroadcastRecv::BroadcastRecv(asio::io_context& io_context, std::string_view any_ip, const SocketOptions& socket_options)
+  : BroadcastRecv(io_context, asio::ip::make_address(any_ip), socket_options) {}
+
+BroadcastRecv::~BroadcastRecv() {
+    StopAsyncRecv();
+    if (async_recv_state_) {
+        // Ensure that posted operations do not access the receiver anymore
+        const std::lock_guard state_lock {async_recv_state_->mutex};
+        async_recv_state_->receiver = nullptr;
+    }
+}
 
 BroadcastMessage BroadcastRecv::RecvBroadcast() {
     BroadcastMessage message {};
@@ -38,10 +146,11 @@ BroadcastMessage BroadcastRecv::RecvBroadcast() {
     auto length = socket_.receive_from(asio::buffer(message.content), sender_endpoint);
 
     // Store IP address
-    message.address = sender_endpoint.address();
+    message.address = normalize_address(sender_endpoint.address());
 
     // Resize content to actual message length
     message.content.resize(length);
+    metrics_.Increment(MetricCounter::DATAGRAMS_RECEIVED);
 
     return message;
 }
@@ -54,18 +163,387 @@ std::optional<BroadcastMessage> BroadcastRecv::AsyncRecvBroadcast(std::chrono::s
     // Receive as future
     auto length_future = socket_.async_receive_from(asio::buffer(message.content), sender_endpoint, asio::use_future);
 
-    // Run IO context for timeout
-    io_context_.restart();
-    io_context_.run_for(timeout);
-
-    // If IO context not stopped, then no message received
-    if (!io_context_.stopped()) {
-        // Cancel async operations
+    if (own_io_context_) {
+        // Run own IO context for timeout, it only has the receive operation as work
+        own_io_context_->restart();
+        own_io_context_->run_for(timeout);
+    }
+    // An external IO context is run by other threads, only wait for the future without touching its run state
+    if (length_future.wait_for(own_io_context_ ? std::chrono::steady_clock::duration::zero() : timeout) !=
+        std::future_status::ready) {
+        // Cancel async operations and wait for the completion, a message received in the meantime is kept
         socket_.cancel();
+        if (own_io_context_) {
+            own_io_context_->restart();
+            own_io_context_->run();
+        }
+    }
+
+    std::size_t length = 0;
+    try {
+        length = length_future.get();
+    }
+    catch (const asio::system_error& error) {
+        if (error.code() != asio::error::operation_aborted) {
+            throw;
+        }
         return std::nullopt;
     }
 
-    message.address = sender_endpoint.address();
-    message.content.resize(length_future.get());
+    message.address = normalize_address(sender_endpoint.address());
+    message.content.resize(length);
+    metrics_.Increment(MetricCounter::DATAGRAMS_RECEIVED);
     return message;
 }
+
+std::span<BatchedBroadcastMessage> BroadcastRecv::RecvBroadcasts(std::span<BatchedBroadcastMessage> messages) {
+    while (true) {
+        // Block until socket is readable
+        socket_.wait(asio::socket_base::wait_read);
+
+        asio::error_code error {};
+        const auto count = RecvPendingBroadcasts(messages, error);
+        if (count > 0) {
+            return messages.first(count);
+        }
+        if (error && error != asio::error::would_block) {
+            throw asio::system_error(error);
+        }
+    }
+}
+
+std::size_t BroadcastRecv::RecvPendingBroadcasts(std::span<BatchedBroadcastMessage> messages, asio::error_code& error) {
+    std::size_t received = 0;
+#if defined(__linux__)
+    while (received < messages.size()) {
+        const auto chunk = std::min(messages.size() - received, RECVMMSG_BATCH);
+
+        // Point message headers directly to the fixed-size buffers
+        std::array<mmsghdr, RECVMMSG_BATCH> headers {};
+        std::array<iovec, RECVMMSG_BATCH> iovecs {};
+        std::array<sockaddr_storage, RECVMMSG_BATCH> addresses {};
+        std::array<ControlBuffer, RECVMMSG_BATCH> controls {};
+        for (std::size_t n = 0; n < chunk; ++n) {
+            auto& message = messages[received + n];
+            iovecs[n].iov_base = message.content.data();
+            iovecs[n].iov_len = message.content.size();
+            headers[n].msg_hdr.msg_iov = &iovecs[n];
+            headers[n].msg_hdr.msg_iovlen = 1;
+            headers[n].msg_hdr.msg_name = &addresses[n];
+            headers[n].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+            headers[n].msg_hdr.msg_control = controls[n].data();
+            headers[n].msg_hdr.msg_controllen = controls[n].size();
+        }
+
+        // Receive without blocking, MSG_TRUNC returns the real length of truncated messages
+        const auto ret = ::recvmmsg(socket_.native_handle(), headers.data(), static_cast<unsigned int>(chunk),
+                                    MSG_DONTWAIT | MSG_TRUNC, nullptr);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (received == 0) {
+                error = (errno == EAGAIN || errno == EWOULDBLOCK) ? asio::error::would_block
+                                                                  : asio::error_code(errno, asio::error::get_system_category());
+            }
+            break;
+        }
+
+        const auto count = static_cast<std::size_t>(ret);
+        for (std::size_t n = 0; n < count; ++n) {
+            auto& message = messages[received + n];
+            message.length = headers[n].msg_len;
+            asio::ip::udp::endpoint sender_endpoint {};
+            std::memcpy(sender_endpoint.data(), &addresses[n], headers[n].msg_hdr.msg_namelen);
+            sender_endpoint.resize(headers[n].msg_hdr.msg_namelen);
+            message.address = normalize_address(sender_endpoint.address());
+        }
+        // Drop counter is cumulative, the last message carries the latest value
+        if (count > 0) {
+            auto& msg_hdr = headers[count - 1].msg_hdr;
+            for (auto* cmsg = CMSG_FIRSTHDR(&msg_hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg_hdr, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_RXQ_OVFL) {
+                    std::uint32_t dropped {};
+                    std::memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+                    dropped_messages_.store(dropped, std::memory_order_relaxed);
+                }
+            }
+        }
+        received += count;
+
+        // Socket drained
+        if (count < chunk) {
+            break;
+        }
+    }
+#else
+    // Fallback: receive one message per call while messages are pending
+    while (received < messages.size()) {
+        // Length of the next pending message, also detects truncation
+        const auto pending = socket_.available(error);
+        if (error || pending == 0) {
+            if (!error && received == 0) {
+                error = asio::error::would_block;
+            }
+            break;
+        }
+        auto& message = messages[received];
+        asio::ip::udp::endpoint sender_endpoint {};
+        socket_.receive_from(asio::buffer(message.content), sender_endpoint, 0, error);
+        if (error && error != asio::error::message_size) {
+            break;
+        }
+        error.clear();
+        message.length = pending;
+        message.address = normalize_address(sender_endpoint.address());
+        ++received;
+    }
+#endif
+    metrics_.Increment(MetricCounter::DATAGRAMS_RECEIVED, received);
+    return received;
+}
+
+bool BroadcastRecv::AttachGroupFilter(std::span<const MD5Hash> group_ids) {
+#if defined(__linux__)
+    if (group_ids.size() > FILTER_MAX_GROUPS) {
+        return false;
+    }
+    // Layout: length check, one block comparing four words per group, reject, accept
+    const auto reject = static_cast<std::uint8_t>(2 + FILTER_GROUP_INSTRUCTIONS * group_ids.size());
+    const auto accept = static_cast<std::uint8_t>(reject + 1);
+    std::vector<sock_filter> program {};
+    program.reserve(accept + 1);
+    program.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_LEN, 0));
+    program.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, FILTER_PAYLOAD_OFFSET + CHIRP_MESSAGE_LENGTH, 0, static_cast<std::uint8_t>(reject - 2)));
+    for (const auto& group_id : group_ids) {
+        const auto next_group = program.size() + FILTER_GROUP_INSTRUCTIONS;
+        for (std::size_t word = 0; word < 4; ++word) {
+            // Absolute loads are in network byte order
+            const auto offset = MessageLayout::GROUP_ID_OFFSET + 4 * word;
+            const std::uint32_t value = (static_cast<std::uint32_t>(group_id[4 * word]) << 24U) |
+                                        (static_cast<std::uint32_t>(group_id[4 * word + 1]) << 16U) |
+                                        (static_cast<std::uint32_t>(group_id[4 * word + 2]) << 8U) |
+                                        static_cast<std::uint32_t>(group_id[4 * word + 3]);
+            program.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, static_cast<std::uint32_t>(FILTER_PAYLOAD_OFFSET + offset)));
+            // Jump offsets are relative to the next instruction
+            const auto position = program.size() + 1;
+            const auto jump_true = static_cast<std::uint8_t>(word == 3 ? accept - position : 0);
+            const auto jump_false = static_cast<std::uint8_t>(next_group - position);
+            program.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, value, jump_true, jump_false));
+        }
+    }
+    program.push_back(BPF_STMT(BPF_RET | BPF_K, 0));
+    program.push_back(BPF_STMT(BPF_RET | BPF_K, 0xFFFFFFFF));
+
+    const sock_fprog fprog {static_cast<unsigned short>(program.size()), program.data()};
+    return ::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_ATTACH_FILTER, &fprog, sizeof(fprog)) == 0;
+#else
+    std::ignore = group_ids;
+    return false;
+#endif
+}
+
+void BroadcastRecv::DetachGroupFilter() {
+#if defined(__linux__)
+    int dummy = 0;
+    ::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_DETACH_FILTER, &dummy, sizeof(dummy));
+#endif
+}
+
+void BroadcastRecv::StartAsyncRecv(AsyncRecvCallback callback) {
+    auto state = std::make_shared<AsyncRecvState>();
+    state->callback = std::move(callback);
+    StartAsyncRecv(std::move(state));
+}
+
+void BroadcastRecv::StartAsyncRecvBatch(AsyncRecvBatchCallback callback, std::size_t batch_size) {
+    auto state = std::make_shared<AsyncRecvState>();
+    state->batch_callback = std::move(callback);
+    state->batch.resize(std::max(batch_size, std::size_t(1)));
+    StartAsyncRecv(std::move(state));
+}
+
+void BroadcastRecv::StartSpinRecvBatch(AsyncRecvBatchCallback callback, std::size_t batch_size, int cpu) {
+    auto state = std::make_shared<AsyncRecvState>();
+    state->batch_callback = std::move(callback);
+    state->batch.resize(std::max(batch_size, std::size_t(1)));
+    state->receiver = this;
+    state->stopped = false;
+    async_recv_state_ = state;
+
+    spin_thread_ = std::jthread([state, cpu](const std::stop_token& stop_token) {
+#if defined(__linux__)
+        if (cpu >= 0) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(static_cast<std::size_t>(cpu), &cpu_set);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+        }
+#else
+        std::ignore = cpu;
+#endif
+        while (!stop_token.stop_requested()) {
+            const std::lock_guard state_lock {state->mutex};
+            if (state->stopped || state->receiver == nullptr) {
+                break;
+            }
+            asio::error_code recv_error {};
+            const auto count = state->receiver->RecvPendingBroadcasts(state->batch, recv_error);
+            if (count > 0) {
+                state->batch_callback(std::span<const BatchedBroadcastMessage>(state->batch).first(count));
+            }
+            else if (recv_error && recv_error != asio::error::would_block) {
+                state->receiver->metrics_.Increment(MetricCounter::RECEIVE_ERRORS);
+            }
+        }
+    });
+}
+
+void BroadcastRecv::StartAsyncRecv(std::shared_ptr<AsyncRecvState> state) {
+    state->receiver = this;
+    state->stopped = false;
+    async_recv_state_ = state;
+
+    // Arm first receive from within the IO context
+    asio::post(io_context_, [state]() {
+        const std::lock_guard state_lock {state->mutex};
+        if (!state->stopped && state->receiver != nullptr) {
+            state->receiver->AsyncRecvNext(state);
+        }
+    });
+}
+
+void BroadcastRecv::StopAsyncRecv() {
+    auto state = async_recv_state_;
+    if (!state) {
+        return;
+    }
+    if (spin_thread_.joinable()) {
+        // Stop polling thread first, it only holds the mutex for a single poll
+        spin_thread_.request_stop();
+        if (spin_thread_.get_id() != std::this_thread::get_id()) {
+            spin_thread_.join();
+        }
+    }
+
+    // Waits until a running callback has finished
+    std::unique_lock state_lock {state->mutex};
+    if (state->stopped) {
+        return;
+    }
+    state->stopped = true;
+    state_lock.unlock();
+
+    // Cancel the pending receive from within the IO context
+    asio::post(io_context_, [state]() {
+        const std::lock_guard state_lock {state->mutex};
+        if (state->receiver != nullptr) {
+            state->receiver->socket_.cancel();
+        }
+        if (state->backoff_timer) {
+            state->backoff_timer->cancel();
+        }
+    });
+}
+
+void BroadcastRecv::RunAsyncRecv() {
+    io_context_.restart();
+    io_context_.run();
+}
+
+void BroadcastRecv::AsyncRecvNext(std::shared_ptr<AsyncRecvState> state) {
+    if (state->batch_callback) {
+        // Wait until readable, then drain all pending messages at once
+        socket_.async_wait(asio::socket_base::wait_read, [state = std::move(state)](const asio::error_code& error) mutable {
+            const std::lock_guard state_lock {state->mutex};
+            if (state->stopped || state->receiver == nullptr || error == asio::error::operation_aborted) {
+                // Stopped or cancelled, do not re-arm
+                return;
+            }
+            asio::error_code recv_error = error;
+            if (!error) {
+                const auto count = state->receiver->RecvPendingBroadcasts(state->batch, recv_error);
+                if (count > 0) {
+                    state->batch_callback(std::span<const BatchedBroadcastMessage>(state->batch).first(count));
+                    recv_error.clear();
+                }
+            }
+            // Callback might have stopped the receive
+            if (state->stopped) {
+                return;
+            }
+            if (recv_error && recv_error != asio::error::would_block) {
+                // Socket errors keep the socket readable, do not re-arm immediately
+                state->receiver->AsyncRecvBackoff(std::move(state));
+                return;
+            }
+            state->receiver->AsyncRecvNext(std::move(state));
+        });
+        return;
+    }
+
+    // Reserve some space for message, does not allocate after first receive
+    state->message.content.resize(MESSAGE_BUFFER);
+
+    auto* state_ptr = state.get();
+    socket_.async_receive_from(
+        asio::buffer(state_ptr->message.content),
+        state_ptr->sender_endpoint,
+        [state = std::move(state)](const asio::error_code& error, std::size_t length) mutable {
+            const std::lock_guard state_lock {state->mutex};
+            if (state->stopped || state->receiver == nullptr || error == asio::error::operation_aborted) {
+                // Stopped or cancelled, do not re-arm
+                return;
+            }
+            if (!error) {
+                state->message.address = normalize_address(state->sender_endpoint.address());
+                state->message.content.resize(length);
+                state->receiver->metrics_.Increment(MetricCounter::DATAGRAMS_RECEIVED);
+                state->callback(state->message);
+            }
+            // Callback might have stopped the receive
+            if (state->stopped) {
+                return;
+            }
+            if (error) {
+                state->receiver->AsyncRecvBackoff(std::move(state));
+                return;
+            }
+            state->receiver->AsyncRecvNext(std::move(state));
+        });
+}
+
+void BroadcastRecv::AsyncRecvBackoff(std::shared_ptr<AsyncRecvState> state) {
+    metrics_.Increment(MetricCounter::RECEIVE_ERRORS);
+    if (!state->backoff_timer) {
+        state->backoff_timer = std::make_unique<asio::steady_timer>(io_context_);
+    }
+    auto* timer = state->backoff_timer.get();
+    timer->expires_after(RECEIVE_ERROR_BACKOFF);
+    timer->async_wait([state = std::move(state)](const asio::error_code& error) mutable {
+        const std::lock_guard state_lock {state->mutex};
+        if (error || state->stopped || state->receiver == nullptr) {
+            return;
+        }
+        state->receiver->AsyncRecvNext(std::move(state));
+    });
+}
+
+bool BroadcastRecv::JoinMulticastGroup(const asio::ip::address& multicast_address) {
+    asio::error_code error {};
+#if defined(__linux__)
+    // Only receive multicast messages of groups joined by this socket
+    const int multicast_all = 0;
+    if (endpoint_.protocol() == asio::ip::udp::v4()) {
+        ::setsockopt(socket_.native_handle(), IPPROTO_IP, IP_MULTICAST_ALL, &multicast_all, sizeof(multicast_all));
+    }
+#endif
+    socket_.set_option(asio::ip::multicast::join_group(multicast_address), error);
+    return !error;
+}
+
+bool BroadcastRecv::LeaveMulticastGroup(const asio::ip::address& multicast_address) {
+    asio::error_code error {};
+    socket_.set_option(asio::ip::multicast::leave_group(multicast_address), error);
+    return !error;
+}
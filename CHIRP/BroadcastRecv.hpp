@@ -1,15 +1,25 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "asio.hpp"
 
 #include "CHIRP/config.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/protocol_info.hpp"
+#include "CHIRP/SocketOptions.hpp"
 
 namespace cnstln {
 namespace CHIRP {
@@ -26,22 +36,94 @@ struct BroadcastMessage {
     CHIRP_API std::string content_to_string() const;
 };
 
-/** Broadcast receiver for incoming CHIRP broadcasts on :cpp:var:`CHIRP_PORT` */
+/**
+ * Incoming broadcast message received as part of a batch
+ *
+ * Since CHIRP messages have a fixed length, the content is stored in a fixed-size buffer of
+ * :cpp:var:`CHIRP_MESSAGE_LENGTH` bytes. Longer broadcast messages are truncated.
+ */
+struct BatchedBroadcastMessage {
+    /** Content of the broadcast message in bytes, only the first ``length`` bytes are valid */
+    std::array<std::uint8_t, CHIRP_MESSAGE_LENGTH> content;
+
+    /** Length of the broadcast message in bytes, larger than the content if the message was truncated */
+    std::size_t length;
+
+    /** Address from which the broadcast message was received */
+    asio::ip::address address;
+};
+
+/**
+ * Function signature for handling asynchronously received broadcast messages
+ *
+ * The callback is executed in the thread running the IO context of the :cpp:class:`BroadcastRecv` (see
+ * :cpp:func:`BroadcastRecv::RunAsyncRecv`). The broadcast message is only valid for the duration of the call.
+ */
+using AsyncRecvCallback = std::function<void(const BroadcastMessage& message)>;
+
+/**
+ * Function signature for handling batches of asynchronously received broadcast messages
+ *
+ * The callback is executed in the thread running the IO context of the :cpp:class:`BroadcastRecv`. The broadcast
+ * messages are only valid for the duration of the call.
+ */
+using AsyncRecvBatchCallback = std::function<void(std::span<const BatchedBroadcastMessage> messages)>;
+
+/**
+ * Broadcast receiver for incoming CHIRP broadcasts on :cpp:var:`CHIRP_PORT`
+ *
+ * When constructed with the IPv6 any address (``::``), the socket is opened in dual-stack mode, such that broadcasts
+ * and multicasts of both IPv4 and IPv6 are received with a single socket. Addresses of IPv4 senders are then reported as
+ * IPv4 addresses, not as IPv4-mapped IPv6 addresses.
+ */
 class BroadcastRecv {
 public:
     /**
      * Construct broadcast receiver
      *
      * @param any_address Address for incoming broadcasts
+     * @param socket_options Options for the socket
      */
-    CHIRP_API BroadcastRecv(asio::ip::address any_address = asio::ip::address_v4::any());
+    CHIRP_API BroadcastRecv(asio::ip::address any_address = asio::ip::address_v4::any(),
+                            const SocketOptions& socket_options = {});
 
     /**
      * Construct broadcast receiver using human readable IP address
      *
      * @param any_ip String containing the IP for incoming broadcasts
+     * @param socket_options Options for the socket
      */
-    CHIRP_API BroadcastRecv(std::string_view any_ip);
+    CHIRP_API BroadcastRecv(std::string_view any_ip, const SocketOptions& socket_options = {});
+
+    /**
+     * Construct broadcast receiver using an external IO context
+     *
+     * This allows to run the asynchronous operations of multiple receivers and senders from a shared IO context, e.g.
+     * using a thread pool managed by the application.
+     *
+     * @param io_context IO context used for the socket, needs to outlive the receiver
+     * @param any_address Address for incoming broadcasts
+     * @param socket_options Options for the socket
+     */
+    CHIRP_API BroadcastRecv(asio::io_context& io_context, asio::ip::address any_address = asio::ip::address_v4::any(),
+                            const SocketOptions& socket_options = {});
+
+    /**
+     * Construct broadcast receiver using an external IO context and human readable IP address
+     *
+     * @param io_context IO context used for the socket, needs to outlive the receiver
+     * @param any_ip String containing the IP for incoming broadcasts
+     * @param socket_options Options for the socket
+     */
+    CHIRP_API BroadcastRecv(asio::io_context& io_context, std::string_view any_ip, const SocketOptions& socket_options = {});
+
+    CHIRP_API ~BroadcastRecv();
+
+    // No copy or move since asynchronous operations reference the receiver
+    BroadcastRecv(const BroadcastRecv& other) = delete;
+    BroadcastRecv& operator=(const BroadcastRecv& other) = delete;
+    BroadcastRecv(BroadcastRecv&& other) = delete;
+    BroadcastRecv& operator=(BroadcastRecv&& other) = delete;
 
     /**
      * Receive broadcast message (blocking)
@@ -53,15 +135,197 @@ public:
     /**
      * Receive broadcast message (asynchronously)
      *
+     * With an own IO context, the IO context is run in the calling thread until the message is received or the timeout
+     * expired. With an external IO context, the IO context needs to be run by other threads, the calling thread only
+     * waits for the completion of the receive operation.
+     *
      * @param timeout Duration for which to block function call
      * @return Broadcast message if received
      */
     CHIRP_API std::optional<BroadcastMessage> AsyncRecvBroadcast(std::chrono::steady_clock::duration timeout);
 
+    /**
+     * Receive a batch of broadcast messages (blocking)
+     *
+     * This blocks until at least one broadcast message is available, and then receives all pending broadcast messages
+     * until the given buffer is full. On Linux, this uses ``recvmmsg`` to receive many messages with a single system call.
+     *
+     * @param messages Buffer for the received broadcast messages, is reused and does not allocate
+     * @return Span of the received broadcast messages, containing at least one message
+     */
+    CHIRP_API std::span<BatchedBroadcastMessage> RecvBroadcasts(std::span<BatchedBroadcastMessage> messages);
+
+    /**
+     * Start receiving broadcast messages continuously
+     *
+     * This keeps a single asynchronous receive operation pending at all times, which is re-armed after each received
+     * message. No timeouts are involved, thus the receiver does not wake up unless a message arrives or the receive is
+     * stopped via :cpp:func:`StopAsyncRecv`. The callback is executed by any thread running the IO context, e.g. via
+     * :cpp:func:`RunAsyncRecv`.
+     *
+     * Note that this should not be mixed with :cpp:func:`AsyncRecvBroadcast`, since that cancels pending operations.
+     *
+     * @param callback Callback executed for every received broadcast message
+     */
+    CHIRP_API void StartAsyncRecv(AsyncRecvCallback callback);
+
+    /**
+     * Start receiving batches of broadcast messages continuously
+     *
+     * Same as :cpp:func:`StartAsyncRecv`, but waits until the socket is readable and then receives all pending broadcast
+     * messages at once (see :cpp:func:`RecvBroadcasts`). This allows to process bursts of broadcast messages without
+     * overrunning the socket buffer.
+     *
+     * @param callback Callback executed for every received batch of broadcast messages
+     * @param batch_size Maximum number of broadcast messages in a batch
+     */
+    CHIRP_API void StartAsyncRecvBatch(AsyncRecvBatchCallback callback, std::size_t batch_size = 64);
+
+    /**
+     * Start receiving batches of broadcast messages continuously via spin polling
+     *
+     * Same as :cpp:func:`StartAsyncRecvBatch`, but instead of waiting in the IO context until the socket is readable, a
+     * dedicated thread polls the socket without blocking in a tight loop. This avoids the wake-up latency of the IO
+     * context at the cost of one fully used CPU core. The callback is executed in the polling thread.
+     *
+     * @param callback Callback executed for every received batch of broadcast messages
+     * @param batch_size Maximum number of broadcast messages in a batch
+     * @param cpu CPU to pin the polling thread to (Linux only), negative to not pin the thread
+     */
+    CHIRP_API void StartSpinRecvBatch(AsyncRecvBatchCallback callback, std::size_t batch_size = 64, int cpu = -1);
+
+    /** Return whether the continuous receive uses spin polling (see :cpp:func:`StartSpinRecvBatch`) */
+    bool SpinPolling() const { return spin_thread_.joinable(); }
+
+    /**
+     * Stop receiving broadcast messages continuously
+     *
+     * The stop is posted to the IO context, and this function can be called from any thread. After this function
+     * returns, the callback passed to :cpp:func:`StartAsyncRecv` or :cpp:func:`StartAsyncRecvBatch` is no longer executed.
+     */
+    CHIRP_API void StopAsyncRecv();
+
+    /**
+     * Run the IO context for continuous receiving (blocking)
+     *
+     * This function returns after :cpp:func:`StopAsyncRecv` was called. When using an external IO context, the IO context
+     * should be run by the application instead.
+     */
+    CHIRP_API void RunAsyncRecv();
+
+    /**
+     * Attach a kernel socket filter accepting only CHIRP broadcasts of the given groups
+     *
+     * On Linux, this attaches a classic BPF program to the socket which compares the length and the group ID of every
+     * incoming datagram, such that broadcasts of other groups are dropped by the kernel before they are queued on the
+     * socket. Attaching a new filter replaces the previous one.
+     *
+     * @param group_ids Group IDs of the broadcasts to accept
+     * @retval true If the filter was attached
+     * @retval false If socket filters are not supported on this platform, or if there are too many groups for a filter
+     */
+    CHIRP_API bool AttachGroupFilter(std::span<const MD5Hash> group_ids);
+
+    /**
+     * Get the number of messages dropped by the kernel for this socket
+     *
+     * On Linux, the count is reported via ``SO_RXQ_OVFL`` with every message received in a batch (see
+     * :cpp:func:`RecvBroadcasts`), thus it is only updated when a message is received after the drops. It includes
+     * messages dropped due to a full receive buffer (see :cpp:member:`SocketOptions::receive_buffer_size`) as well as
+     * messages rejected by a kernel socket filter (see :cpp:func:`AttachGroupFilter`). On other platforms, zero is
+     * returned.
+     *
+     * @return Number of dropped messages since the socket was opened
+     */
+    std::uint32_t GetDroppedMessages() const { return dropped_messages_.load(std::memory_order_relaxed); }
+
+    /** Detach a kernel socket filter attached via :cpp:func:`AttachGroupFilter` */
+    CHIRP_API void DetachGroupFilter();
+
+    /** Return the metrics of the receiver, see :cpp:class:`Metrics` */
+    const Metrics& GetMetrics() const { return metrics_; }
+
+    /**
+     * Join a multicast group to receive CHIRP messages sent to its address
+     *
+     * The receiver needs to be bound to an any address of the same IP version as the multicast address. On Linux, the
+     * socket only receives multicast messages of the groups it joined itself, not those joined by other sockets.
+     *
+     * @param multicast_address Multicast address of the group (see :cpp:func:`MulticastAddress`)
+     * @retval true If the group was joined
+     * @retval false If joining failed, e.g. since there is no interface with multicast support
+     */
+    CHIRP_API bool JoinMulticastGroup(const asio::ip::address& multicast_address);
+
+    /**
+     * Leave a multicast group joined via :cpp:func:`JoinMulticastGroup`
+     *
+     * @param multicast_address Multicast address of the group
+     * @retval true If the group was left
+     * @retval false If the group was not joined
+     */
+    CHIRP_API bool LeaveMulticastGroup(const asio::ip::address& multicast_address);
+
+private:
+    /**
+     * Construct broadcast receiver
+     *
+     * @param own_io_context IO context owned by the receiver, or nullptr if external
+     * @param external_io_context External IO context, or nullptr to use own IO context
+     * @param any_address Address for incoming broadcasts
+     * @param socket_options Options for the socket
+     */
+    BroadcastRecv(std::unique_ptr<asio::io_context> own_io_context, asio::io_context* external_io_context,
+                  asio::ip::address any_address, const SocketOptions& socket_options);
+
+    /** State shared with pending asynchronous operations started via :cpp:func:`StartAsyncRecv` */
+    struct AsyncRecvState;
+
+    /**
+     * Start continuous receive with the given state
+     *
+     * @param state State of the continuous receive
+     */
+    void StartAsyncRecv(std::shared_ptr<AsyncRecvState> state);
+
+    /**
+     * Receive pending broadcast messages without blocking
+     *
+     * @param messages Buffer for the received broadcast messages
+     * @param error Set to :cpp:var:`asio::error::would_block` if no message is pending, or other errors
+     * @return Number of received broadcast messages
+     */
+    std::size_t RecvPendingBroadcasts(std::span<BatchedBroadcastMessage> messages, asio::error_code& error);
+
+    /**
+     * Arm the next asynchronous receive operation
+     *
+     * @param state State of the continuous receive
+     */
+    void AsyncRecvNext(std::shared_ptr<AsyncRecvState> state);
+
+    /**
+     * Arm the next asynchronous receive operation after a failed receive once the back-off expired
+     *
+     * @param state State of the continuous receive
+     */
+    void AsyncRecvBackoff(std::shared_ptr<AsyncRecvState> state);
+
 private:
-    asio::io_context io_context_;
+    std::unique_ptr<asio::io_context> own_io_context_;
+    asio::io_context& io_context_;
     asio::ip::udp::endpoint endpoint_;
     asio::ip::udp::socket socket_;
+    std::shared_ptr<AsyncRecvState> async_recv_state_;
+
+    /** Number of messages dropped by the kernel, as last reported via ``SO_RXQ_OVFL`` */
+    std::atomic<std::uint32_t> dropped_messages_ {0};
+
+    /** Metrics of the receiver */
+    Metrics metrics_;
+
+    /** Thread polling the socket, only running when spin polling */
+    std::jthread spin_thread_;
 };
 
 } // namespace CHIRP
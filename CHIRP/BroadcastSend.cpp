@@ -1,26 +1,250 @@
 #include "BroadcastSend.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <sys/socket.h>
+#endif
+
+#include "CHIRP/BoundedQueue.hpp"
 #include "CHIRP/protocol_info.hpp"
 
 using namespace cnstln::CHIRP;
 
-BroadcastSend::BroadcastSend(asio::ip::address brd_address)
-  : io_context_(), endpoint_(std::move(brd_address), asio::ip::port_type(CHIRP_PORT)),
-    socket_(io_context_, endpoint_.protocol()) {
-    // Set reuseable address and broadcast socket options
-    socket_.set_option(asio::socket_base::reuse_address(true));
-    socket_.set_option(asio::socket_base::broadcast(true));
-    // Set broadcast address for use in send() function
-    socket_.connect(endpoint_);
+/** Maximum number of queued messages sent in a single batch */
+constexpr std::size_t ASYNC_SEND_BATCH = 64;
+
+struct BroadcastSend::AsyncSendState {
+    AsyncSendState(std::size_t queue_capacity, OverflowPolicy overflow_policy)
+      : queue(queue_capacity), overflow_policy(overflow_policy), drain_scheduled(false) {}
+
+    /** Queue of outgoing messages */
+    BoundedQueue<AssembledMessage> queue;
+
+    /** Policy when the queue is full */
+    OverflowPolicy overflow_policy;
+
+    /** Whether draining of the queue is already posted to the IO context */
+    std::atomic_bool drain_scheduled;
+
+    /** Mutex held while draining the queue or modifying the sender */
+    std::mutex mutex;
+
+    /** Sender owning the socket, nullptr once the sender is destroyed */
+    BroadcastSend* sender;
+};
+
+#if defined(__linux__)
+/** Maximum number of messages sent with a single sendmmsg call */
+constexpr std::size_t SENDMMSG_BATCH = 64;
+#endif
+
+namespace {
+    /** Single unbound interface for a broadcast address */
+    std::vector<NetworkInterface> broadcast_interfaces(asio::ip::address brd_address) {
+        std::vector<NetworkInterface> interfaces {};
+        interfaces.emplace_back(std::string(), asio::ip::address(), std::move(brd_address));
+        return interfaces;
+    }
+} // namespace
+
+BroadcastSend::BroadcastSend(std::unique_ptr<asio::io_context> own_io_context, asio::io_context* external_io_context,
+                             std::vector<NetworkInterface> interfaces, const SocketOptions& socket_options)
+  : own_io_context_(std::move(own_io_context)),
+    io_context_(external_io_context != nullptr ? *external_io_context : *own_io_context_) {
+    if (interfaces.empty()) {
+        interfaces.emplace_back(std::string(), asio::ip::address(), asio::ip::address_v4::any());
+    }
+    sockets_.reserve(interfaces.size());
+    for (const auto& network_interface : interfaces) {
+        const asio::ip::udp::endpoint endpoint {network_interface.broadcast_address, asio::ip::port_type(CHIRP_PORT)};
+        auto& socket = sockets_.emplace_back(io_context_, endpoint.protocol());
+        // Set reuseable address and broadcast socket options
+        socket.set_option(asio::socket_base::reuse_address(true));
+        socket.set_option(asio::socket_base::broadcast(true));
+        socket_options.Apply(socket);
+        // Bind to interface address such that broadcasts leave via the interface with its address as source
+        if (!network_interface.address.is_unspecified()) {
+            socket.bind({network_interface.address, 0});
+        }
+        if (network_interface.broadcast_address.is_multicast()) {
+            // Stay in local network and loop back to local receivers
+            socket.set_option(asio::ip::multicast::hops(1));
+            socket.set_option(asio::ip::multicast::enable_loopback(true));
+            if (network_interface.address.is_v4() && !network_interface.address.is_unspecified()) {
+                socket.set_option(asio::ip::multicast::outbound_interface(network_interface.address.to_v4()));
+            }
+        }
+        // Set broadcast address for use in send() function
+        socket.connect(endpoint);
+    }
 }
 
-BroadcastSend::BroadcastSend(std::string_view brd_ip)
-  : BroadcastSend(asio::ip::make_address(brd_ip)) {}
+BroadcastSend::BroadcastSend(asio::ip::address brd_address, const SocketOptions& socket_options)
+  : BroadcastSend(std::make_unique<asio::io_context>(), nullptr, broadcast_interfaces(std::move(brd_address)), socket_options) {}
+
+BroadcastSend::BroadcastSend(std::string_view brd_ip, const SocketOptions& socket_options)
+  : BroadcastSend(asio::ip::make_address(brd_ip), socket_options) {}
+
+BroadcastSend::BroadcastSend(asio::io_context& io_context, asio::ip::address brd_address, const SocketOptions& socket_options)
+  : BroadcastSend(nullptr, &io_context, broadcast_interfaces(std::move(brd_address)), socket_options) {}
+
+BroadcastSend::BroadcastSend(asio::io_context& io_context, std::string_view brd_ip, const SocketOptions& socket_options)
+  : BroadcastSend(io_context, asio::ip::make_address(brd_ip), socket_options) {}
+
+BroadcastSend::BroadcastSend(std::span<const NetworkInterface> interfaces, const SocketOptions& socket_options)
+  : BroadcastSend(std::make_unique<asio::io_context>(), nullptr, {interfaces.begin(), interfaces.end()}, socket_options) {}
+
+BroadcastSend::BroadcastSend(asio::io_context& io_context, std::span<const NetworkInterface> interfaces,
+                             const SocketOptions& socket_options)
+  : BroadcastSend(nullptr, &io_context, {interfaces.begin(), interfaces.end()}, socket_options) {}
+
+BroadcastSend::~BroadcastSend() {
+    if (async_send_state_) {
+        // Send remaining messages and ensure that posted operations do not access the sender anymore
+        const std::lock_guard state_lock {async_send_state_->mutex};
+        try {
+            DrainQueue(*async_send_state_);
+        }
+        catch (const asio::system_error& error) {
+            // Nothing we can do in the destructor
+        }
+        async_send_state_->sender = nullptr;
+    }
+}
 
 void BroadcastSend::SendBroadcast(std::string_view message) {
-    socket_.send(asio::buffer(message));
+    SendBroadcast(message.data(), message.size());
 }
 
 void BroadcastSend::SendBroadcast(const void* data, std::size_t size) {
-    socket_.send(asio::const_buffer(data, size));
+    for (auto& socket : sockets_) {
+        socket.send(asio::const_buffer(data, size));
+        metrics_.Increment(MetricCounter::MESSAGES_SENT);
+    }
+}
+
+void BroadcastSend::SendBroadcasts(std::span<const AssembledMessage> messages) {
+    for (auto& socket : sockets_) {
+        SendBroadcasts(socket, messages);
+        metrics_.Increment(MetricCounter::MESSAGES_SENT, messages.size());
+    }
+}
+
+void BroadcastSend::SendBroadcasts(asio::ip::udp::socket& socket, std::span<const AssembledMessage> messages) {
+#if defined(__linux__)
+    std::size_t sent = 0;
+    while (sent < messages.size()) {
+        const auto chunk = std::min(messages.size() - sent, SENDMMSG_BATCH);
+
+        // Socket is connected to the broadcast address, thus no address needed per message
+        std::array<mmsghdr, SENDMMSG_BATCH> headers {};
+        std::array<iovec, SENDMMSG_BATCH> iovecs {};
+        for (std::size_t n = 0; n < chunk; ++n) {
+            // sendmmsg does not modify the buffers
+            iovecs[n].iov_base = const_cast<std::uint8_t*>(messages[sent + n].data());
+            iovecs[n].iov_len = messages[sent + n].size();
+            headers[n].msg_hdr.msg_iov = &iovecs[n];
+            headers[n].msg_hdr.msg_iovlen = 1;
+        }
+
+        const auto ret = ::sendmmsg(socket.native_handle(), headers.data(), static_cast<unsigned int>(chunk), 0);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw asio::system_error(asio::error_code(errno, asio::error::get_system_category()));
+        }
+        // Might send less messages than requested, continue with remaining
+        sent += static_cast<std::size_t>(ret);
+    }
+#else
+    // Fallback: send one message per call
+    for (const auto& message : messages) {
+        socket.send(asio::buffer(message));
+    }
+#endif
+}
+
+void BroadcastSend::SetMulticastTTL(int ttl) {
+    for (auto& socket : sockets_) {
+        socket.set_option(asio::ip::multicast::hops(ttl));
+    }
+}
+
+void BroadcastSend::SetMulticastLoopback(bool loopback) {
+    for (auto& socket : sockets_) {
+        socket.set_option(asio::ip::multicast::enable_loopback(loopback));
+    }
+}
+
+void BroadcastSend::EnableAsyncSend(std::size_t queue_capacity, OverflowPolicy overflow_policy) {
+    auto state = std::make_shared<AsyncSendState>(queue_capacity, overflow_policy);
+    state->sender = this;
+    async_send_state_ = std::move(state);
+}
+
+bool BroadcastSend::AsyncSendEnabled() const {
+    return static_cast<bool>(async_send_state_);
+}
+
+bool BroadcastSend::AsyncSendBroadcast(const AssembledMessage& message) {
+    if (!async_send_state_) {
+        SendBroadcast(message.data(), message.size());
+        return true;
+    }
+    auto& state = *async_send_state_;
+
+    if (!state.queue.TryPush(message)) {
+        // Queue full
+        if (state.overflow_policy == OverflowPolicy::SEND_SYNC) {
+            // Send queued messages first such that the message does not overtake them
+            const std::lock_guard state_lock {state.mutex};
+            DrainQueue(state);
+            SendBroadcast(message.data(), message.size());
+            return true;
+        }
+        metrics_.Increment(MetricCounter::SEND_QUEUE_OVERFLOWS);
+        return false;
+    }
+
+    // Post draining of the queue unless already posted
+    if (!state.drain_scheduled.exchange(true, std::memory_order_acq_rel)) {
+        asio::post(io_context_, [state = async_send_state_]() {
+            const std::lock_guard state_lock {state->mutex};
+            // Reset flag before draining such that messages queued during draining post a new drain
+            state->drain_scheduled.store(false, std::memory_order_release);
+            if (state->sender != nullptr) {
+                try {
+                    DrainQueue(*state);
+                }
+                catch (const asio::system_error& error) {
+                    // Sending failed, messages are lost as for synchronous broadcasts
+                    state->sender->metrics_.Increment(MetricCounter::SEND_ERRORS);
+                }
+            }
+        });
+    }
+    return true;
+}
+
+void BroadcastSend::DrainQueue(AsyncSendState& state) {
+    std::array<AssembledMessage, ASYNC_SEND_BATCH> batch {};
+    while (true) {
+        std::size_t count = 0;
+        while (count < batch.size() && state.queue.TryPop(batch[count])) {
+            ++count;
+        }
+        if (count == 0) {
+            break;
+        }
+        state.sender->SendBroadcasts(std::span<const AssembledMessage>(batch).first(count));
+    }
 }
@@ -1,30 +1,104 @@
 #pragma once
 
+#include <memory>
+#include <span>
 #include <string_view>
+#include <vector>
 
 #include "asio.hpp"
 
 #include "CHIRP/config.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/NetworkInterface.hpp"
+#include "CHIRP/SocketOptions.hpp"
 
 namespace cnstln {
 namespace CHIRP {
 
-/** Broadcast sender for outgoing CHIRP broadcasts on :cpp:var:`CHIRP_PORT` */
+/** Policy for asynchronous sending when the outgoing queue of a :cpp:class:`BroadcastSend` is full */
+enum class OverflowPolicy {
+    /** Drop the message that could not be queued */
+    DROP,
+
+    /** Send the queued messages and then the message that could not be queued synchronously in the calling thread */
+    SEND_SYNC,
+};
+
+/**
+ * Broadcast sender for outgoing CHIRP broadcasts on :cpp:var:`CHIRP_PORT`
+ *
+ * The sender either broadcasts to a single broadcast address, or to the broadcast addresses of multiple network
+ * interfaces (see :cpp:func:`GetNetworkInterfaces`). In the latter case, the sender keeps one socket per interface bound
+ * to the address of the interface, and every message is sent on all interfaces.
+ *
+ * Instead of a broadcast address, a multicast address can be used (see :cpp:func:`MulticastAddress`). Then only hosts
+ * which joined the multicast group receive the messages. By default, multicast messages are not routed beyond the local
+ * network and are looped back to receivers on the sending host.
+ */
 class BroadcastSend {
 public:
     /**
      * Construct broadcast sender
      *
      * @param brd_address Broadcast address for outgoing broadcasts
+     * @param socket_options Options for the socket
      */
-    CHIRP_API BroadcastSend(asio::ip::address brd_address = asio::ip::address_v4::any());
+    CHIRP_API BroadcastSend(asio::ip::address brd_address = asio::ip::address_v4::any(),
+                            const SocketOptions& socket_options = {});
 
     /**
      * Construct broadcast sender using human readable IP address
      *
      * @param brd_ip String containing the broadcast IP for outgoing broadcasts
+     * @param socket_options Options for the socket
+     */
+    CHIRP_API BroadcastSend(std::string_view brd_ip, const SocketOptions& socket_options = {});
+
+    /**
+     * Construct broadcast sender using an external IO context
+     *
+     * @param io_context IO context used for the socket, needs to outlive the sender
+     * @param brd_address Broadcast address for outgoing broadcasts
+     * @param socket_options Options for the socket
+     */
+    CHIRP_API BroadcastSend(asio::io_context& io_context, asio::ip::address brd_address = asio::ip::address_v4::any(),
+                            const SocketOptions& socket_options = {});
+
+    /**
+     * Construct broadcast sender using an external IO context and human readable IP address
+     *
+     * @param io_context IO context used for the socket, needs to outlive the sender
+     * @param brd_ip String containing the broadcast IP for outgoing broadcasts
+     * @param socket_options Options for the socket
+     */
+    CHIRP_API BroadcastSend(asio::io_context& io_context, std::string_view brd_ip, const SocketOptions& socket_options = {});
+
+    /**
+     * Construct broadcast sender for multiple network interfaces
+     *
+     * @param interfaces Network interfaces to broadcast on, if empty the default broadcast address is used
+     * @param socket_options Options for the sockets
+     */
+    CHIRP_API BroadcastSend(std::span<const NetworkInterface> interfaces, const SocketOptions& socket_options = {});
+
+    /**
+     * Construct broadcast sender for multiple network interfaces using an external IO context
+     *
+     * @param io_context IO context used for the sockets, needs to outlive the sender
+     * @param interfaces Network interfaces to broadcast on, if empty the default broadcast address is used
+     * @param socket_options Options for the sockets
      */
-    CHIRP_API BroadcastSend(std::string_view brd_ip);
+    CHIRP_API BroadcastSend(asio::io_context& io_context, std::span<const NetworkInterface> interfaces,
+                            const SocketOptions& socket_options = {});
+
+    CHIRP_API ~BroadcastSend();
+
+    // No copy or move since asynchronous operations reference the sender
+    BroadcastSend(const BroadcastSend& other) = delete;
+    BroadcastSend& operator=(const BroadcastSend& other) = delete;
+    BroadcastSend(BroadcastSend&& other) = delete;
+    BroadcastSend& operator=(BroadcastSend&& other) = delete;
 
     /**
      * Send broadcast message from string
@@ -41,10 +115,98 @@ public:
      */
     CHIRP_API void SendBroadcast(const void* data, std::size_t size);
 
+    /**
+     * Send multiple CHIRP messages as individual broadcasts
+     *
+     * On Linux, this uses ``sendmmsg`` to send many messages with a single system call per interface.
+     *
+     * @param messages Assembled CHIRP messages to send
+     */
+    CHIRP_API void SendBroadcasts(std::span<const AssembledMessage> messages);
+
+    /**
+     * Set the time to live of outgoing multicast messages
+     *
+     * @param ttl Maximum number of hops, one to stay in the local network
+     */
+    CHIRP_API void SetMulticastTTL(int ttl);
+
+    /**
+     * Set whether outgoing multicast messages are looped back to receivers on the sending host
+     *
+     * @param loopback True to loop back multicast messages
+     */
+    CHIRP_API void SetMulticastLoopback(bool loopback);
+
+    /**
+     * Enable asynchronous sending via :cpp:func:`AsyncSendBroadcast`
+     *
+     * Messages are queued in a bounded lock-free queue, which is drained by the threads running the IO context of the
+     * sender. Thus the IO context needs to be running for messages to be sent. Messages still queued when the sender is
+     * destroyed are sent synchronously.
+     *
+     * @param queue_capacity Minimum number of messages that can be queued
+     * @param overflow_policy Policy when the queue is full
+     */
+    CHIRP_API void EnableAsyncSend(std::size_t queue_capacity = 256, OverflowPolicy overflow_policy = OverflowPolicy::DROP);
+
+    /** Return if asynchronous sending is enabled */
+    CHIRP_API bool AsyncSendEnabled() const;
+
+    /**
+     * Send CHIRP message asynchronously
+     *
+     * This function returns immediately without waiting for the socket. If asynchronous sending is not enabled, the message
+     * is sent synchronously.
+     *
+     * @param message Assembled CHIRP message to send
+     * @retval true If the message was queued or sent
+     * @retval false If the message was dropped since the queue is full
+     */
+    CHIRP_API bool AsyncSendBroadcast(const AssembledMessage& message);
+
+    /** Return the metrics of the sender, see :cpp:class:`Metrics` */
+    const Metrics& GetMetrics() const { return metrics_; }
+
 private:
-    asio::io_context io_context_;
-    asio::ip::udp::endpoint endpoint_;
-    asio::ip::udp::socket socket_;
+    /**
+     * Construct broadcast sender
+     *
+     * @param own_io_context IO context owned by the sender, or nullptr if external
+     * @param external_io_context External IO context, or nullptr to use own IO context
+     * @param interfaces Network interfaces to broadcast on, an unspecified interface address leaves the socket unbound
+     * @param socket_options Options for the sockets
+     */
+    BroadcastSend(std::unique_ptr<asio::io_context> own_io_context, asio::io_context* external_io_context,
+                  std::vector<NetworkInterface> interfaces, const SocketOptions& socket_options);
+
+    /**
+     * Send multiple CHIRP messages as individual broadcasts on a single socket
+     *
+     * @param socket Socket connected to a broadcast address
+     * @param messages Assembled CHIRP messages to send
+     */
+    static void SendBroadcasts(asio::ip::udp::socket& socket, std::span<const AssembledMessage> messages);
+
+    /** State shared with pending asynchronous operations started via :cpp:func:`AsyncSendBroadcast` */
+    struct AsyncSendState;
+
+    /**
+     * Send all queued messages
+     *
+     * @param state State of the asynchronous sending
+     */
+    static void DrainQueue(AsyncSendState& state);
+
+private:
+    std::unique_ptr<asio::io_context> own_io_context_;
+    asio::io_context& io_context_;
+    /** One socket per network interface, each connected to the broadcast address of its interface */
+    std::vector<asio::ip::udp::socket> sockets_;
+    std::shared_ptr<AsyncSendState> async_send_state_;
+
+    /** Metrics of the sender */
+    Metrics metrics_;
 };
 
 } // namespace CHIRP
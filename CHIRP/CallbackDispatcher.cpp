@@ -0,0 +1,91 @@
+#include "CallbackDispatcher.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace cnstln::CHIRP;
+
+namespace {
+    /** Two threads such that a blocked lane does not stall all others, but not more than lanes */
+    std::size_t default_threads(std::size_t lanes) {
+        return std::clamp<std::size_t>(lanes, 1, 2);
+    }
+} // namespace
+
+struct CallbackDispatcher::Lanes {
+    struct Lane {
+        /** Mutex for thread-safe access to the queued tasks */
+        std::mutex mutex;
+
+        /** Queued tasks */
+        std::vector<Task> tasks;
+
+        /** Whether draining of the lane is already posted to the executor */
+        bool scheduled {false};
+    };
+
+    Lanes(asio::any_io_executor executor, std::size_t count)
+      : executor(std::move(executor)), count(std::max(count, std::size_t(1))), lanes(std::make_unique<Lane[]>(this->count)) {}
+
+    /** Executor on which tasks are executed */
+    asio::any_io_executor executor;
+
+    /** Number of lanes */
+    std::size_t count;
+
+    /** Array of lanes */
+    std::unique_ptr<Lane[]> lanes;
+};
+
+CallbackDispatcher::CallbackDispatcher(std::size_t threads, std::size_t lanes)
+  : own_thread_pool_(std::in_place, threads > 0 ? threads : default_threads(lanes)),
+    lanes_(std::make_shared<Lanes>(own_thread_pool_->get_executor(), lanes)) {}
+
+CallbackDispatcher::CallbackDispatcher(asio::any_io_executor executor, std::size_t lanes)
+  : lanes_(std::make_shared<Lanes>(std::move(executor), lanes)) {}
+
+CallbackDispatcher::~CallbackDispatcher() {
+    if (own_thread_pool_) {
+        // Waits until all posted drains are finished
+        own_thread_pool_->join();
+    }
+}
+
+void CallbackDispatcher::Dispatch(std::size_t key, Task task) {
+    const auto lane = key % lanes_->count;
+    auto& lane_ref = lanes_->lanes[lane];
+
+    const std::lock_guard lane_lock {lane_ref.mutex};
+    lane_ref.tasks.emplace_back(std::move(task));
+    // Post drain unless already posted
+    if (!lane_ref.scheduled) {
+        lane_ref.scheduled = true;
+        asio::post(lanes_->executor, [lanes = lanes_, lane]() { DrainLane(lanes, lane); });
+    }
+}
+
+void CallbackDispatcher::DrainLane(std::shared_ptr<Lanes> lanes, std::size_t lane) {
+    auto& lane_ref = lanes->lanes[lane];
+
+    // Take all queued tasks at once
+    std::vector<Task> tasks {};
+    {
+        const std::lock_guard lane_lock {lane_ref.mutex};
+        tasks.swap(lane_ref.tasks);
+    }
+
+    for (auto& task : tasks) {
+        task();
+    }
+
+    // Post another drain if tasks were queued in the meantime, this keeps other lanes from starving
+    const std::lock_guard lane_lock {lane_ref.mutex};
+    if (lane_ref.tasks.empty()) {
+        lane_ref.scheduled = false;
+    }
+    else {
+        asio::post(lanes->executor, [lanes, lane]() { DrainLane(lanes, lane); });
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+
+#include "asio.hpp"
+
+#include "CHIRP/config.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * Dispatcher executing user callbacks on a worker pool or an executor
+ *
+ * Tasks are distributed to a fixed number of lanes based on a key. Tasks in the same lane are executed in the order in
+ * which they were dispatched and never concurrently, while different lanes are executed in parallel. Each lane is drained
+ * in batches, such that a burst of tasks only requires a single handoff to the executor.
+ */
+class CallbackDispatcher {
+public:
+    /** Task executed by the dispatcher */
+    using Task = std::function<void()>;
+
+    /**
+     * Construct dispatcher with an own worker pool
+     *
+     * @param threads Number of worker threads, zero for two threads (or one with a single lane)
+     * @param lanes Number of lanes for ordered execution
+     */
+    CHIRP_API CallbackDispatcher(std::size_t threads = 0, std::size_t lanes = 8);
+
+    /**
+     * Construct dispatcher using an external executor
+     *
+     * @param executor Executor on which tasks are executed, needs to outlive the dispatcher or to be stopped before
+     * @param lanes Number of lanes for ordered execution
+     */
+    CHIRP_API CallbackDispatcher(asio::any_io_executor executor, std::size_t lanes = 8);
+
+    /**
+     * Destruct dispatcher
+     *
+     * When using an own worker pool, this waits until all dispatched tasks are executed.
+     */
+    CHIRP_API ~CallbackDispatcher();
+
+    // No copy or move since dispatched tasks reference the dispatcher state
+    CallbackDispatcher(const CallbackDispatcher& other) = delete;
+    CallbackDispatcher& operator=(const CallbackDispatcher& other) = delete;
+    CallbackDispatcher(CallbackDispatcher&& other) = delete;
+    CallbackDispatcher& operator=(CallbackDispatcher&& other) = delete;
+
+    /**
+     * Dispatch a task
+     *
+     * @param key Key selecting the lane, tasks with the same key are executed in order
+     * @param task Task to execute
+     */
+    CHIRP_API void Dispatch(std::size_t key, Task task);
+
+private:
+    /** Lanes shared with posted drains */
+    struct Lanes;
+
+    /**
+     * Execute queued tasks of a lane
+     *
+     * @param lanes Lanes of the dispatcher
+     * @param lane Index of the lane to execute
+     */
+    static void DrainLane(std::shared_ptr<Lanes> lanes, std::size_t lane);
+
+private:
+    std::optional<asio::thread_pool> own_thread_pool_;
+    std::shared_ptr<Lanes> lanes_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
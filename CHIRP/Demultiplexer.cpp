@@ -0,0 +1,191 @@
+#include "Demultiplexer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "CHIRP/Manager.hpp"
+#include "CHIRP/Multicast.hpp"
+
+using namespace cnstln::CHIRP;
+
+Demultiplexer::Demultiplexer(asio::io_context& io_context, asio::ip::address any_address, const SocketOptions& socket_options)
+  : io_context_(io_context), receiver_(std::in_place, io_context_, std::move(any_address), socket_options),
+    transport_(nullptr), spin_poll_(socket_options.spin_poll), spin_poll_cpu_(socket_options.spin_poll_cpu) {}
+
+Demultiplexer::Demultiplexer(asio::io_context& io_context, std::string_view any_ip, const SocketOptions& socket_options)
+  : Demultiplexer(io_context, asio::ip::make_address(any_ip), socket_options) {}
+
+Demultiplexer::Demultiplexer(asio::io_context& io_context, Transport& transport)
+  : io_context_(io_context), transport_(&transport), spin_poll_(false), spin_poll_cpu_(-1) {}
+
+Demultiplexer::~Demultiplexer() {
+    Stop();
+}
+
+void Demultiplexer::Start() {
+    if (transport_ != nullptr) {
+        transport_->StartReceive(std::bind_front(&Demultiplexer::HandleBroadcasts, this));
+        return;
+    }
+    if (spin_poll_) {
+        receiver_->StartSpinRecvBatch(std::bind_front(&Demultiplexer::HandleBroadcasts, this), 64, spin_poll_cpu_);
+        return;
+    }
+    receiver_->StartAsyncRecvBatch(std::bind_front(&Demultiplexer::HandleBroadcasts, this));
+}
+
+MetricsSnapshot Demultiplexer::GetMetricsSnapshot() const {
+    auto snapshot = metrics_.Snapshot();
+    snapshot += transport_ != nullptr ? transport_->GetMetricsSnapshot() : receiver_->GetMetrics().Snapshot();
+    return snapshot;
+}
+
+void Demultiplexer::Stop() {
+    if (transport_ != nullptr) {
+        transport_->StopReceive();
+        return;
+    }
+    receiver_->StopAsyncRecv();
+}
+
+bool Demultiplexer::EnableKernelFilter() {
+    const std::lock_guard managers_lock {managers_mutex_};
+    // Transports deliver all messages to user space
+    kernel_filter_ = transport_ == nullptr;
+    UpdateKernelFilter();
+    return kernel_filter_;
+}
+
+bool Demultiplexer::EnableMulticast(bool ipv6) {
+    const std::lock_guard managers_lock {managers_mutex_};
+    if (transport_ != nullptr) {
+        return false;
+    }
+    multicast_ = true;
+    multicast_v6_ = ipv6;
+    bool joined = true;
+    for (const auto& [group_id, group_managers] : managers_) {
+        joined &= UpdateMulticastGroup(group_id, true);
+    }
+    return joined;
+}
+
+bool Demultiplexer::UpdateMulticastGroup(const MD5Hash& group_id, bool join) {
+    if (!multicast_) {
+        return true;
+    }
+    const auto multicast_address = MulticastAddress(group_id, multicast_v6_);
+    return join ? receiver_->JoinMulticastGroup(multicast_address) : receiver_->LeaveMulticastGroup(multicast_address);
+}
+
+void Demultiplexer::EnableDuplicateFilter(std::chrono::steady_clock::duration window, std::size_t slots) {
+    const std::lock_guard managers_lock {managers_mutex_};
+    duplicate_filter_ = std::make_unique<DuplicateFilter>(window, slots);
+}
+
+void Demultiplexer::UpdateKernelFilter() {
+    if (!kernel_filter_) {
+        return;
+    }
+    std::vector<MD5Hash> group_ids {};
+    group_ids.reserve(managers_.size());
+    for (const auto& [group_id, group_managers] : managers_) {
+        group_ids.push_back(group_id);
+    }
+    if (!receiver_->AttachGroupFilter(group_ids)) {
+        receiver_->DetachGroupFilter();
+        kernel_filter_ = false;
+    }
+}
+
+bool Demultiplexer::RegisterManager(Manager* manager) {
+    const std::lock_guard managers_lock {managers_mutex_};
+    auto& group_managers = managers_[manager->GetGroupID()];
+    if (std::ranges::find(group_managers, manager) != group_managers.end()) {
+        return false;
+    }
+    group_managers.push_back(manager);
+    if (group_managers.size() == 1) {
+        UpdateKernelFilter();
+        UpdateMulticastGroup(manager->GetGroupID(), true);
+    }
+    return true;
+}
+
+bool Demultiplexer::UnregisterManager(Manager* manager) {
+    // Waits until running dispatches are finished
+    const std::lock_guard managers_lock {managers_mutex_};
+    auto group_it = managers_.find(manager->GetGroupID());
+    if (group_it == managers_.end()) {
+        return false;
+    }
+    auto& group_managers = group_it->second;
+    const auto erase_ret = std::erase(group_managers, manager);
+    if (group_managers.empty()) {
+        managers_.erase(group_it);
+        UpdateKernelFilter();
+        UpdateMulticastGroup(manager->GetGroupID(), false);
+    }
+    return erase_ret > 0;
+}
+
+void Demultiplexer::HandleBroadcasts(std::span<const BatchedBroadcastMessage> raw_msgs) {
+    // Lock once for the whole batch
+    const std::shared_lock managers_lock {managers_mutex_};
+    // Managers which handled a message in this batch
+    std::vector<Manager*> handled_managers {};
+    // Single arrival time for the whole batch
+    const auto now = duplicate_filter_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+    for (const auto& raw_msg : raw_msgs) {
+        if (raw_msg.length != CHIRP_MESSAGE_LENGTH) {
+            // Not a CHIRP message, ignore
+            metrics_.Increment(MetricCounter::DROPPED_LENGTH);
+            continue;
+        }
+        if (duplicate_filter_ && duplicate_filter_->IsDuplicate(raw_msg.content, MessageLayout::TYPE_OFFSET, now)) {
+            // Same broadcast received shortly before, e.g. via another interface
+            metrics_.Increment(MetricCounter::DROPPED_DUPLICATE);
+            continue;
+        }
+        // Validate in place in the receive buffer, junk traffic is dropped without throwing
+        const auto decode_start = Metrics::Now();
+        const auto view = MessageView::Decode(raw_msg.content);
+        metrics_.RecordSince(MetricHistogram::DECODE_TIME, decode_start);
+        if (!view) {
+            metrics_.Increment(MetricCounter::DROPPED_DECODE_ERROR);
+            continue;
+        }
+        const auto group_it = managers_.find(view->GetGroupID());
+        if (group_it == managers_.end()) {
+            // Broadcast from group without registered manager, ignore
+            metrics_.Increment(MetricCounter::DROPPED_FOREIGN_GROUP);
+            continue;
+        }
+        // Decode only once for all managers, and only if any manager is not the sender
+        const auto host_id = view->GetHostID();
+        std::optional<Message> chirp_msg {};
+        for (auto* manager : group_it->second) {
+            if (host_id == manager->GetHostID()) {
+                // Broadcast from self, ignore
+                metrics_.Increment(MetricCounter::DROPPED_SELF);
+                continue;
+            }
+            if (!chirp_msg.has_value()) {
+                chirp_msg.emplace(view->ToMessage());
+            }
+            manager->HandleMessage(chirp_msg.value(), raw_msg.address);
+            if (std::ranges::find(handled_managers, manager) == handled_managers.end()) {
+                handled_managers.push_back(manager);
+            }
+        }
+    }
+    // Deliver discovery events gathered over the batch
+    for (auto* manager : handled_managers) {
+        manager->FlushDiscoveryEvents();
+    }
+}
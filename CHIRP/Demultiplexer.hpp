@@ -0,0 +1,248 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "CHIRP/config.hpp"
+#include "CHIRP/BroadcastRecv.hpp"
+#include "CHIRP/DuplicateFilter.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/SocketOptions.hpp"
+#include "CHIRP/Transport.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+class Manager;
+
+/**
+ * Demultiplexer for incoming CHIRP broadcasts shared between multiple managers
+ *
+ * The demultiplexer owns a single :cpp:class:`BroadcastRecv` and decodes every incoming CHIRP broadcast exactly once.
+ * Broadcasts of foreign groups and broadcasts sent by the receiving manager itself are rejected in place in the receive
+ * buffer before being decoded.
+ * Broadcasts are received in batches, such that bursts of broadcasts are drained from the socket at once.
+ * The message is then routed via a hash lookup of the group ID to all managers registered for that group. This avoids
+ * that each manager binds its own socket and decodes every broadcast, such that the cost per message does not grow with
+ * the number of groups on the host. With the IPv6 any address, IPv4 and IPv6 broadcasts are received by the same
+ * dual-stack socket and routed to the same managers.
+ *
+ * Instead of its own :cpp:class:`BroadcastRecv`, the demultiplexer can receive via a :cpp:class:`Transport`, e.g. a
+ * :cpp:class:`MemoryTransport` for simulations without sockets.
+ */
+class Demultiplexer {
+public:
+    /**
+     * @param io_context IO context used for the socket, needs to outlive the demultiplexer
+     * @param any_address Any address for incoming broadcast messages
+     * @param socket_options Options for the receiving socket
+     */
+    CHIRP_API Demultiplexer(asio::io_context& io_context, asio::ip::address any_address = asio::ip::address_v4::any(),
+                            const SocketOptions& socket_options = {});
+
+    /**
+     * @param io_context IO context used for the socket, needs to outlive the demultiplexer
+     * @param any_ip Any IP for incoming broadcast messages
+     * @param socket_options Options for the receiving socket
+     */
+    CHIRP_API Demultiplexer(asio::io_context& io_context, std::string_view any_ip, const SocketOptions& socket_options = {});
+
+    /**
+     * Construct demultiplexer receiving via a transport instead of a socket
+     *
+     * @param io_context IO context used for the timers of the managers, needs to outlive the demultiplexer
+     * @param transport Transport for incoming messages, needs to outlive the demultiplexer
+     */
+    CHIRP_API Demultiplexer(asio::io_context& io_context, Transport& transport);
+
+    CHIRP_API ~Demultiplexer();
+
+    // No copy or move since managers reference the demultiplexer
+    Demultiplexer(const Demultiplexer& other) = delete;
+    Demultiplexer& operator=(const Demultiplexer& other) = delete;
+    Demultiplexer(Demultiplexer&& other) = delete;
+    Demultiplexer& operator=(Demultiplexer&& other) = delete;
+
+    /** Get the IO context used by the demultiplexer */
+    asio::io_context& GetIOContext() { return io_context_; }
+
+    /**
+     * Start receiving incoming CHIRP broadcasts
+     *
+     * The broadcasts are handled by the threads running the IO context, or by a dedicated polling thread if
+     * :cpp:member:`SocketOptions::spin_poll` is set.
+     */
+    CHIRP_API void Start();
+
+    /** Return whether the broadcasts are received by a dedicated polling thread */
+    bool SpinPolling() const { return spin_poll_; }
+
+    /** Return whether the broadcasts are received outside of the IO context, i.e. via spin polling or a transport */
+    bool ReceivesExternally() const { return spin_poll_ || transport_ != nullptr; }
+
+    /** Get the transport for incoming messages, or nullptr if the demultiplexer uses its own socket */
+    Transport* GetTransport() const { return transport_; }
+
+    /**
+     * Get the number of broadcasts dropped by the kernel, e.g. due to a full receive buffer
+     *
+     * See :cpp:func:`BroadcastRecv::GetDroppedMessages` and :cpp:func:`Transport::GetDroppedMessages`.
+     *
+     * @return Number of dropped broadcasts
+     */
+    std::uint32_t GetDroppedMessages() const {
+        return transport_ != nullptr ? transport_->GetDroppedMessages() : receiver_->GetDroppedMessages();
+    }
+
+    /**
+     * Get the metrics of the demultiplexer
+     *
+     * This includes the dropped and decoded broadcasts of the demultiplexer as well as the metrics of its receiver or
+     * transport.
+     *
+     * @return Combined snapshot of the metrics
+     */
+    CHIRP_API MetricsSnapshot GetMetricsSnapshot() const;
+
+    /** Stop receiving incoming CHIRP broadcasts */
+    CHIRP_API void Stop();
+
+    /**
+     * Enable the kernel socket filter for the groups of the registered managers
+     *
+     * The filter is updated whenever a manager is registered or unregistered, such that broadcasts of other groups are
+     * dropped by the kernel (see :cpp:func:`BroadcastRecv::AttachGroupFilter`). Without kernel filter, these broadcasts
+     * are still rejected before being decoded.
+     *
+     * @retval true If the filter was attached
+     * @retval false If socket filters are not supported or a transport is used, the broadcasts are filtered in user
+     * space only
+     */
+    CHIRP_API bool EnableKernelFilter();
+
+    /**
+     * Enable receiving CHIRP messages via multicast
+     *
+     * The demultiplexer joins the multicast group of every group with a registered manager (see
+     * :cpp:func:`MulticastAddress`) and leaves it again when the last manager of the group is unregistered. Broadcasts
+     * are still received. The managers need to send to the multicast address of their group.
+     *
+     * @param ipv6 Whether to join IPv6 multicast groups, requires an IPv6 any address
+     * @retval true If the multicast groups of all registered managers were joined
+     * @retval false If joining a multicast group failed or a transport is used
+     */
+    CHIRP_API bool EnableMulticast(bool ipv6 = false);
+
+    /**
+     * Enable the filter for duplicate broadcasts
+     *
+     * Broadcasts with exactly the same content as a broadcast received within the time window are discarded before they
+     * are decoded or routed to the managers (see :cpp:class:`DuplicateFilter`). This avoids handling the same broadcast
+     * multiple times on hosts with several interfaces. Broadcasts are only discarded if they repeat the last message type
+     * of the same host and service: a service which is offered, departs and is offered again within the window is
+     * delivered with all three broadcasts. Only a broadcast which is legitimately sent twice in a row within the window,
+     * e.g. a REQUEST, is delivered once.
+     *
+     * @param window Time window in which identical broadcasts are considered duplicates
+     * @param slots Number of remembered broadcasts
+     */
+    CHIRP_API void EnableDuplicateFilter(std::chrono::steady_clock::duration window = std::chrono::milliseconds(1),
+                                         std::size_t slots = 1024);
+
+    /**
+     * Register a manager to receive the CHIRP broadcasts of its group
+     *
+     * @param manager Manager to register, needs to be unregistered before it is destroyed
+     * @retval true If the manager was registered
+     * @retval false If the manager was already registered
+     */
+    CHIRP_API bool RegisterManager(Manager* manager);
+
+    /**
+     * Unregister a previously registered manager
+     *
+     * After this function returns, the manager is not accessed by the demultiplexer anymore.
+     *
+     * @param manager Manager to unregister
+     * @retval true If the manager was unregistered
+     * @retval false If the manager was never registered
+     */
+    CHIRP_API bool UnregisterManager(Manager* manager);
+
+private:
+    /**
+     * Decode a batch of incoming broadcasts and route them to the managers of their group
+     *
+     * @param raw_msgs Batch of broadcast messages received by the receiver
+     */
+    void HandleBroadcasts(std::span<const BatchedBroadcastMessage> raw_msgs);
+
+    /**
+     * Attach the kernel socket filter for the current groups
+     *
+     * Requires :cpp:member:`managers_mutex_` to be locked by the caller. Detaches the filter if the groups do not fit in a
+     * single filter, such that no broadcasts are lost.
+     */
+    void UpdateKernelFilter();
+
+    /**
+     * Join or leave the multicast group of a group if multicast is enabled
+     *
+     * Requires :cpp:member:`managers_mutex_` to be locked by the caller.
+     *
+     * @param group_id Group ID of the group
+     * @param join True to join the group, false to leave it
+     * @return True if multicast is disabled or joining or leaving succeeded
+     */
+    bool UpdateMulticastGroup(const MD5Hash& group_id, bool join);
+
+private:
+    asio::io_context& io_context_;
+
+    /** Own receiver, empty if a transport is used */
+    std::optional<BroadcastRecv> receiver_;
+
+    /** Transport for incoming messages, nullptr if the own receiver is used */
+    Transport* transport_;
+
+    /** Registered managers by group ID */
+    std::unordered_map<MD5Hash, std::vector<Manager*>> managers_;
+
+    /** Mutex for thread-safe access to :cpp:member:`managers_`, held in shared mode while dispatching */
+    std::shared_mutex managers_mutex_;
+
+    /** Whether to receive via a dedicated polling thread */
+    bool spin_poll_;
+
+    /** CPU to pin the polling thread to */
+    int spin_poll_cpu_;
+
+    /** Whether the kernel socket filter is enabled */
+    bool kernel_filter_ {false};
+
+    /** Whether multicast receiving is enabled */
+    bool multicast_ {false};
+
+    /** Whether to join IPv6 multicast groups */
+    bool multicast_v6_ {false};
+
+    /** Filter for duplicate broadcasts, nullptr if disabled, guarded by :cpp:member:`managers_mutex_` */
+    std::unique_ptr<DuplicateFilter> duplicate_filter_;
+
+    /** Metrics of the demultiplexer */
+    Metrics metrics_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
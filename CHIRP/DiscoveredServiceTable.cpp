@@ -0,0 +1,173 @@
+#include "DiscoveredServiceTable.hpp"
+
+#include <compare>
+#include <functional>
+#include <utility>
+
+using namespace cnstln::CHIRP;
+
+namespace {
+    /** Initial number of slots in the index, needs to be a power of two */
+    constexpr std::size_t INITIAL_SLOTS = 16;
+
+    /** Mask for the index in a slot position */
+    constexpr std::uint32_t POSITION_INDEX_MASK = 0x00FFFFFF;
+
+    /** Compare the key of two services */
+    bool same_key(const DiscoveredService& lhs, const DiscoveredService& rhs) {
+        return lhs.host_id == rhs.host_id && lhs.identifier == rhs.identifier && lhs.port == rhs.port;
+    }
+} // namespace
+
+bool DiscoveredService::operator<(const DiscoveredService& other) const {
+    // Ignore IP when sorting, we only care about the host
+    auto ord_host_id = host_id <=> other.host_id;
+    if (std::is_lt(ord_host_id)) {
+        return true;
+    }
+    if (std::is_gt(ord_host_id)) {
+        return false;
+    }
+    // Same as RegisteredService::operator<
+    auto ord_id = std::to_underlying(identifier) <=> std::to_underlying(other.identifier);
+    if (std::is_lt(ord_id)) {
+        return true;
+    }
+    if (std::is_gt(ord_id)) {
+        return false;
+    }
+    return port < other.port;
+}
+
+DiscoveredServiceTable::DiscoveredServiceTable() : slots_(INITIAL_SLOTS), size_(0) {}
+
+std::uint32_t DiscoveredServiceTable::KeyHash(const DiscoveredService& service) {
+    // Host ID is hashed with a single 128-bit load, then mixed with service identifier and port
+    const std::uint64_t key = (static_cast<std::uint64_t>(std::to_underlying(service.identifier)) << 16U) | service.port;
+    const std::uint64_t hash = (std::hash<MD5Hash>()(service.host_id) ^ key) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::uint32_t>(hash >> 32U);
+}
+
+std::size_t DiscoveredServiceTable::ListIndex(ServiceIdentifier service_id) {
+    return static_cast<std::size_t>(std::to_underlying(service_id) - std::to_underlying(CONTROL));
+}
+
+std::size_t DiscoveredServiceTable::FindSlot(const DiscoveredService& service, std::uint32_t hash) const {
+    const auto mask = slots_.size() - 1;
+    const auto list = ListIndex(service.identifier);
+    for (auto slot = hash & mask;; slot = (slot + 1) & mask) {
+        const auto& entry = slots_[slot];
+        if (entry.position == 0) {
+            return slot;
+        }
+        // Compare hash and list before touching the service
+        if (entry.hash == hash && (entry.position >> 24U) == list &&
+            same_key(lists_[list][(entry.position & POSITION_INDEX_MASK) - 1], service)) {
+            return slot;
+        }
+    }
+}
+
+bool DiscoveredServiceTable::Contains(const DiscoveredService& service) const {
+    return slots_[FindSlot(service, KeyHash(service))].position != 0;
+}
+
+bool DiscoveredServiceTable::Insert(const DiscoveredService& service, const Timestamps& timestamps) {
+    const auto hash = KeyHash(service);
+    auto slot = FindSlot(service, hash);
+    if (slots_[slot].position != 0) {
+        return false;
+    }
+    // Keep load factor below 1/2 to keep probe sequences short
+    if (2 * (size_ + 1) > slots_.size()) {
+        Grow();
+        slot = FindSlot(service, hash);
+    }
+    const auto list = ListIndex(service.identifier);
+    lists_[list].push_back(service);
+    timestamps_[list].push_back(timestamps);
+    slots_[slot] = {hash, static_cast<std::uint32_t>((list << 24U) | lists_[list].size())};
+    ++size_;
+    return true;
+}
+
+bool DiscoveredServiceTable::Erase(const DiscoveredService& service) {
+    auto slot = FindSlot(service, KeyHash(service));
+    if (slots_[slot].position == 0) {
+        return false;
+    }
+    const auto list = ListIndex(service.identifier);
+    auto& services = lists_[list];
+    const auto index = (slots_[slot].position & POSITION_INDEX_MASK) - 1;
+
+    // Move last service of the list into the gap and update its slot
+    if (index + 1 != services.size()) {
+        auto& moved_slot = slots_[FindSlot(services.back(), KeyHash(services.back()))];
+        moved_slot.position = static_cast<std::uint32_t>((list << 24U) | (index + 1));
+        services[index] = std::move(services.back());
+        timestamps_[list][index] = timestamps_[list].back();
+    }
+    services.pop_back();
+    timestamps_[list].pop_back();
+
+    // Backward-shift deletion: move following slots back unless they are at their home slot
+    const auto mask = slots_.size() - 1;
+    for (auto next = (slot + 1) & mask; slots_[next].position != 0; next = (next + 1) & mask) {
+        const auto home = slots_[next].hash & mask;
+        if (((next - home) & mask) >= ((next - slot) & mask)) {
+            slots_[slot] = slots_[next];
+            slot = next;
+        }
+    }
+    slots_[slot] = {0, 0};
+    --size_;
+    return true;
+}
+
+DiscoveredServiceTable::Timestamps* DiscoveredServiceTable::FindTimestamps(const DiscoveredService& service) {
+    const auto position = slots_[FindSlot(service, KeyHash(service))].position;
+    if (position == 0) {
+        return nullptr;
+    }
+    return &timestamps_[position >> 24U][(position & POSITION_INDEX_MASK) - 1];
+}
+
+void DiscoveredServiceTable::Clear() {
+    for (auto& services : lists_) {
+        services.clear();
+    }
+    for (auto& timestamps : timestamps_) {
+        timestamps.clear();
+    }
+    slots_.assign(slots_.size(), {0, 0});
+    size_ = 0;
+}
+
+std::span<const DiscoveredService> DiscoveredServiceTable::Get(ServiceIdentifier service_id) const {
+    return lists_[ListIndex(service_id)];
+}
+
+std::vector<DiscoveredService> DiscoveredServiceTable::GetAll() const {
+    std::vector<DiscoveredService> ret {};
+    ret.reserve(size_);
+    for (const auto& services : lists_) {
+        ret.insert(ret.end(), services.begin(), services.end());
+    }
+    return ret;
+}
+
+void DiscoveredServiceTable::Grow() {
+    std::vector<Slot> slots(slots_.size() * 2);
+    const auto mask = slots.size() - 1;
+    for (const auto& entry : slots_) {
+        if (entry.position == 0) {
+            continue;
+        }
+        auto slot = entry.hash & mask;
+        while (slots[slot].position != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = entry;
+    }
+    slots_ = std::move(slots);
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "CHIRP/config.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/protocol_info.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/** A service discovered by the :cpp:class:`Manager` */
+struct DiscoveredService {
+    /** Address of the discovered service */
+    asio::ip::address address;
+
+    /** Host ID of the discovered service */
+    MD5Hash host_id;
+
+    /** Service identifier of the discovered service */
+    ServiceIdentifier identifier;
+
+    /** Port of the discovered service */
+    Port port;
+
+    CHIRP_API bool operator<(const DiscoveredService& other) const;
+};
+
+/**
+ * Flat hash table of discovered services
+ *
+ * Services are identified by host ID, service identifier and port, the address is ignored. The services are stored
+ * contiguously in one dense list per service identifier, which serves as secondary index. The lists are indexed by an
+ * open-addressing table with linear probing, which stores a hash fragment and the position of each service. Erasing
+ * moves the last service of a list into the gap and uses backward-shift deletion in the index, such that neither the
+ * lists nor the index contain holes or tombstones.
+ *
+ * Each service carries timestamps for liveness tracking, which are stored alongside the services but are not part of
+ * the key.
+ *
+ * The table is not thread-safe.
+ */
+class DiscoveredServiceTable {
+public:
+    /** Liveness timestamps of a service */
+    struct Timestamps {
+        /** Time when the service was last seen */
+        std::chrono::steady_clock::time_point last_seen;
+        /** Time for which the expiry check of the service is scheduled */
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+public:
+    CHIRP_API DiscoveredServiceTable();
+
+    /**
+     * Check if a service is in the table
+     *
+     * @param service Service to look up
+     * @return True if a service with the same host ID, service identifier and port is in the table
+     */
+    CHIRP_API bool Contains(const DiscoveredService& service) const;
+
+    /**
+     * Insert a service into the table
+     *
+     * @param service Service to insert
+     * @param timestamps Liveness timestamps of the service
+     * @retval true If the service was inserted
+     * @retval false If the service was already in the table, in which case its timestamps are not modified
+     */
+    CHIRP_API bool Insert(const DiscoveredService& service, const Timestamps& timestamps = {});
+
+    /**
+     * Erase a service from the table
+     *
+     * Note that this changes the order of the services with the same service identifier.
+     *
+     * @param service Service to erase
+     * @retval true If the service was erased
+     * @retval false If the service was not in the table
+     */
+    CHIRP_API bool Erase(const DiscoveredService& service);
+
+    /**
+     * Find the liveness timestamps of a service
+     *
+     * @param service Service to look up
+     * @return Pointer to the timestamps, valid until the table is modified, or nullptr if the service is not in the table
+     */
+    CHIRP_API Timestamps* FindTimestamps(const DiscoveredService& service);
+
+    /** Erase all services from the table */
+    CHIRP_API void Clear();
+
+    /** Return the number of services in the table */
+    std::size_t Size() const { return size_; }
+
+    /** Return whether the table is empty */
+    bool Empty() const { return size_ == 0; }
+
+    /**
+     * Get all services with a given service identifier
+     *
+     * @param service_id Service identifier of the services
+     * @return Span over the services, valid until the table is modified
+     */
+    CHIRP_API std::span<const DiscoveredService> Get(ServiceIdentifier service_id) const;
+
+    /**
+     * Get all services in the table
+     *
+     * @return Vector with all services, ordered by service identifier
+     */
+    CHIRP_API std::vector<DiscoveredService> GetAll() const;
+
+private:
+    /** Slot in the index */
+    struct Slot {
+        /** Upper bits of the key hash */
+        std::uint32_t hash;
+        /** Position of the service, list in the upper 8 bits and index plus one in the lower 24 bits, zero if empty */
+        std::uint32_t position;
+    };
+
+    /** Hash of the key of a service */
+    static std::uint32_t KeyHash(const DiscoveredService& service);
+
+    /** Index of the list for a service identifier */
+    static std::size_t ListIndex(ServiceIdentifier service_id);
+
+    /** Find the slot of a service, or the empty slot where it would be inserted */
+    std::size_t FindSlot(const DiscoveredService& service, std::uint32_t hash) const;
+
+    /** Double the size of the index and reinsert all services */
+    void Grow();
+
+private:
+    std::array<std::vector<DiscoveredService>, SERVICE_IDENTIFIER_COUNT> lists_;
+    std::array<std::vector<Timestamps>, SERVICE_IDENTIFIER_COUNT> timestamps_;
+    std::vector<Slot> slots_;
+    std::size_t size_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
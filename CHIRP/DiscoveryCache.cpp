@@ -0,0 +1,167 @@
+#include "DiscoveryCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "asio.hpp"
+
+#include "CHIRP/protocol_info.hpp"
+
+using namespace cnstln::CHIRP;
+
+// Header:  magic (4) | version (2) | reserved (2) | group ID (16) | number of services (4)
+// Record:  address (16) | address family (1) | service identifier (1) | port (2) | host ID (16)
+// Integers are stored in network byte order, IPv4 addresses in the first four bytes of the address field.
+
+namespace {
+    constexpr std::uint8_t FAMILY_V4 = 4;
+    constexpr std::uint8_t FAMILY_V6 = 6;
+
+    void write_uint(std::uint8_t* out, std::uint32_t value, std::size_t bytes) {
+        for (std::size_t n = 0; n < bytes; ++n) {
+            out[n] = static_cast<std::uint8_t>(value >> (8 * (bytes - 1 - n)));
+        }
+    }
+
+    std::uint32_t read_uint(const std::uint8_t* in, std::size_t bytes) {
+        std::uint32_t value = 0;
+        for (std::size_t n = 0; n < bytes; ++n) {
+            value = (value << 8) | in[n];
+        }
+        return value;
+    }
+
+    /** Decode a snapshot, returns no services if it is invalid */
+    std::vector<DiscoveredService> decode(std::span<const std::uint8_t> data, const MD5Hash& group_id) {
+        if (data.size() < DiscoveryCache::HEADER_SIZE || read_uint(data.data(), 4) != DiscoveryCache::MAGIC ||
+            read_uint(data.data() + 4, 2) != DiscoveryCache::VERSION ||
+            !std::ranges::equal(data.subspan(8, group_id.size()), group_id)) {
+            return {};
+        }
+        const auto count = read_uint(data.data() + 24, 4);
+        if (data.size() != DiscoveryCache::HEADER_SIZE + std::size_t(count) * DiscoveryCache::RECORD_SIZE) {
+            return {};
+        }
+        std::vector<DiscoveredService> services {};
+        services.reserve(count);
+        for (std::size_t offset = DiscoveryCache::HEADER_SIZE; offset < data.size(); offset += DiscoveryCache::RECORD_SIZE) {
+            const auto* record = data.data() + offset;
+            const auto identifier = record[17];
+            if (identifier < std::to_underlying(CONTROL) ||
+                identifier >= std::to_underlying(CONTROL) + SERVICE_IDENTIFIER_COUNT) {
+                return {};
+            }
+            auto& service = services.emplace_back();
+            if (record[16] == FAMILY_V4) {
+                asio::ip::address_v4::bytes_type bytes {};
+                std::copy_n(record, bytes.size(), bytes.begin());
+                service.address = asio::ip::address_v4(bytes);
+            }
+            else if (record[16] == FAMILY_V6) {
+                asio::ip::address_v6::bytes_type bytes {};
+                std::copy_n(record, bytes.size(), bytes.begin());
+                service.address = asio::ip::address_v6(bytes);
+            }
+            else {
+                return {};
+            }
+            service.identifier = static_cast<ServiceIdentifier>(identifier);
+            service.port = static_cast<Port>(read_uint(record + 18, 2));
+            std::copy_n(record + 20, service.host_id.size(), service.host_id.begin());
+        }
+        return services;
+    }
+} // namespace
+
+DiscoveryCache::DiscoveryCache(std::filesystem::path directory, const MD5Hash& group_id)
+  : path_(std::move(directory) / (group_id.to_string() + ".chirp")), group_id_(group_id) {}
+
+std::vector<DiscoveredService> DiscoveryCache::Load() const {
+#if !defined(_WIN32)
+    const auto fd = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return {};
+    }
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0 || file_stat.st_size < static_cast<off_t>(HEADER_SIZE)) {
+        ::close(fd);
+        return {};
+    }
+    const auto size = static_cast<std::size_t>(file_stat.st_size);
+    auto* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // Mapping stays valid after closing the file
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return {};
+    }
+    auto services = decode({static_cast<const std::uint8_t*>(mapping), size}, group_id_);
+    ::munmap(mapping, size);
+    return services;
+#else
+    // No memory mapping, read whole file instead
+    std::ifstream file {path_, std::ios::binary};
+    if (!file) {
+        return {};
+    }
+    const std::vector<std::uint8_t> data {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    return decode(data, group_id_);
+#endif
+}
+
+bool DiscoveryCache::Store(std::span<const DiscoveredService> services) const {
+    std::vector<std::uint8_t> data(HEADER_SIZE + services.size() * RECORD_SIZE);
+    write_uint(data.data(), MAGIC, 4);
+    write_uint(data.data() + 4, VERSION, 2);
+    std::ranges::copy(group_id_, data.begin() + 8);
+    write_uint(data.data() + 24, static_cast<std::uint32_t>(services.size()), 4);
+    auto* record = data.data() + HEADER_SIZE;
+    for (const auto& service : services) {
+        if (service.address.is_v4()) {
+            std::ranges::copy(service.address.to_v4().to_bytes(), record);
+            record[16] = FAMILY_V4;
+        }
+        else {
+            std::ranges::copy(service.address.to_v6().to_bytes(), record);
+            record[16] = FAMILY_V6;
+        }
+        record[17] = std::to_underlying(service.identifier);
+        write_uint(record + 18, service.port, 2);
+        std::ranges::copy(service.host_id, record + 20);
+        record += RECORD_SIZE;
+    }
+
+    // Write to temporary file and replace snapshot, such that readers never see a partial snapshot
+    std::error_code ec {};
+    std::filesystem::create_directories(path_.parent_path(), ec);
+    if (ec) {
+        return false;
+    }
+    auto tmp_path = path_;
+    tmp_path += ".tmp";
+    {
+        std::ofstream file {tmp_path, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        file.close();
+        if (!file) {
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp_path, path_, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "CHIRP/config.hpp"
+#include "CHIRP/DiscoveredServiceTable.hpp"
+#include "CHIRP/Message.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * On-disk snapshot of the discovered services of a group
+ *
+ * The snapshot is stored in one file per group ID, named after the hexadecimal group ID in the cache directory. The
+ * file consists of a header with a magic number, the format version, the group ID and the number of services, followed
+ * by one fixed-size record per service. The file is memory-mapped for loading, such that loading a large snapshot only
+ * decodes the records without copying the file. Snapshots are written to a temporary file which then replaces the
+ * previous snapshot, such that a crash while storing never leaves a truncated snapshot behind.
+ *
+ * The cache is used by the :cpp:class:`Manager` for fast warm restarts, see :cpp:func:`Manager::SetDiscoveryCache`.
+ */
+class DiscoveryCache {
+public:
+    /** Magic number at the beginning of a snapshot */
+    static constexpr std::uint32_t MAGIC = 0x43485043; // "CHPC"
+
+    /** Version of the snapshot format */
+    static constexpr std::uint16_t VERSION = 1;
+
+    /** Size of the header in bytes */
+    static constexpr std::size_t HEADER_SIZE = 28;
+
+    /** Size of a record in bytes */
+    static constexpr std::size_t RECORD_SIZE = 36;
+
+    /**
+     * @param directory Directory containing the snapshots, created when storing if it does not exist
+     * @param group_id Group ID of the snapshot
+     */
+    CHIRP_API DiscoveryCache(std::filesystem::path directory, const MD5Hash& group_id);
+
+    /** Get the path of the snapshot */
+    const std::filesystem::path& GetPath() const { return path_; }
+
+    /**
+     * Load the snapshot
+     *
+     * @return Services of the snapshot, empty if the snapshot does not exist, belongs to another group or is invalid
+     */
+    CHIRP_API std::vector<DiscoveredService> Load() const;
+
+    /**
+     * Store a snapshot, replacing the previous snapshot
+     *
+     * @param services Services of the snapshot
+     * @retval true If the snapshot was stored
+     * @retval false If the snapshot could not be written
+     */
+    CHIRP_API bool Store(std::span<const DiscoveredService> services) const;
+
+private:
+    std::filesystem::path path_;
+    MD5Hash group_id_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
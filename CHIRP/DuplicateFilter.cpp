@@ -0,0 +1,74 @@
+#include "DuplicateFilter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+using namespace cnstln::CHIRP;
+
+namespace {
+    /** Mix a 64-bit value into a hash state */
+    constexpr std::uint64_t mix(std::uint64_t hash, std::uint64_t value) {
+        hash = (hash ^ value) * 0xBF58476D1CE4E5B9ULL;
+        return hash ^ (hash >> 31U);
+    }
+} // namespace
+
+DuplicateFilter::DuplicateFilter(std::chrono::steady_clock::duration window, std::size_t slots)
+  : window_(window), start_(std::chrono::steady_clock::now()), mask_(std::bit_ceil(std::max(slots, std::size_t(1))) - 1),
+    slots_(std::make_unique<std::atomic<std::uint64_t>[]>(mask_ + 1)) {}
+
+std::uint64_t DuplicateFilter::Hash(std::span<const std::uint8_t> content) {
+    return Hash(content, content.size());
+}
+
+std::uint64_t DuplicateFilter::Hash(std::span<const std::uint8_t> content, std::size_t skip_offset) {
+    std::uint64_t hash = 0x9E3779B97F4A7C15ULL ^ content.size();
+    // Word-sized loads, a CHIRP message needs five words and a two-byte tail
+    for (std::size_t offset = 0; offset < content.size(); offset += sizeof(std::uint64_t)) {
+        std::array<std::uint8_t, sizeof(std::uint64_t)> bytes {};
+        const auto length = std::min(bytes.size(), content.size() - offset);
+        std::memcpy(bytes.data(), content.data() + offset, length);
+        if (skip_offset >= offset && skip_offset < offset + length) {
+            bytes[skip_offset - offset] = 0;
+        }
+        std::uint64_t word {};
+        std::memcpy(&word, bytes.data(), sizeof(word));
+        hash = mix(hash, word);
+    }
+    return mix(hash, 0x94D049BB133111EBULL);
+}
+
+bool DuplicateFilter::IsDuplicate(std::span<const std::uint8_t> content, std::chrono::steady_clock::time_point now) {
+    const auto hash = Hash(content);
+    // Upper bits of the hash are the tag, never zero such that empty slots never match
+    return IsDuplicate(hash, (hash >> 32U) | 1U, now);
+}
+
+bool DuplicateFilter::IsDuplicate(std::span<const std::uint8_t> content, std::size_t variant_offset,
+                                  std::chrono::steady_clock::time_point now) {
+    if (variant_offset >= content.size()) {
+        return IsDuplicate(content, now);
+    }
+    // Slot without the variant, tag with the variant such that other variants replace the slot
+    const auto hash = Hash(content, variant_offset);
+    return IsDuplicate(hash, (mix(hash, content[variant_offset]) >> 32U) | 1U, now);
+}
+
+bool DuplicateFilter::IsDuplicate(std::uint64_t hash, std::uint64_t tag, std::chrono::steady_clock::time_point now) {
+    // Lower bits of the hash select the slot
+    auto& slot = slots_[hash & mask_];
+    // Arrival time in microseconds, truncated to 32 bits and wrapping after about 71 minutes
+    const auto time = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - start_).count());
+
+    const auto entry = slot.load(std::memory_order_relaxed);
+    if ((entry >> 32U) == tag) {
+        const auto age = static_cast<std::uint32_t>(time - static_cast<std::uint32_t>(entry));
+        if (std::chrono::microseconds(age) < window_) {
+            return true;
+        }
+    }
+    slot.store((tag << 32U) | time, std::memory_order_relaxed);
+    return false;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "CHIRP/config.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * Lock-free filter for broadcasts received multiple times in short succession
+ *
+ * On hosts with multiple interfaces, or when several senders relay the same broadcast, the exact same message can
+ * arrive several times. The filter remembers a hash of the raw bytes of recent messages in a direct-mapped table of
+ * atomic slots, each packing a hash tag and the arrival time. A message is a duplicate if its slot holds the same tag
+ * from within the time window. Duplicates do not extend the window, such that periodically repeated messages still
+ * pass once per window. Optionally, one byte of the message can be treated as variant, e.g. the message type: messages
+ * only differing in the variant share a slot, such that a message of another variant evicts the previous one and a
+ * repeat after another variant is not a duplicate.
+ *
+ * Concurrent receivers never block each other. Two identical messages checked at the same time might both pass, and
+ * colliding messages evict each other, which only means that a duplicate is not detected.
+ */
+class DuplicateFilter {
+public:
+    /**
+     * @param window Time window in which identical messages are considered duplicates
+     * @param slots Number of remembered messages, rounded up to the next power of two
+     */
+    CHIRP_API DuplicateFilter(std::chrono::steady_clock::duration window, std::size_t slots = 1024);
+
+    /**
+     * Check if a message is a duplicate and remember it otherwise
+     *
+     * @param content Raw bytes of the message
+     * @param now Arrival time of the message
+     * @return True if an identical message was seen within the time window
+     */
+    CHIRP_API bool IsDuplicate(std::span<const std::uint8_t> content, std::chrono::steady_clock::time_point now);
+
+    /**
+     * Check if a message is a duplicate of the last message of the same slot and remember it otherwise
+     *
+     * The slot is selected without the variant byte, such that e.g. an OFFER, a DEPART and again an OFFER of the same
+     * service are never duplicates of each other, while repeats of the same message are.
+     *
+     * @param content Raw bytes of the message
+     * @param variant_offset Offset of the variant byte in the message
+     * @param now Arrival time of the message
+     * @return True if an identical message was the last message of its slot within the time window
+     */
+    CHIRP_API bool IsDuplicate(std::span<const std::uint8_t> content, std::size_t variant_offset,
+                               std::chrono::steady_clock::time_point now);
+
+    /** Return the time window */
+    std::chrono::steady_clock::duration Window() const { return window_; }
+
+    /**
+     * Fast non-cryptographic hash of raw bytes
+     *
+     * @param content Bytes to hash
+     * @return 64-bit hash
+     */
+    CHIRP_API static std::uint64_t Hash(std::span<const std::uint8_t> content);
+
+private:
+    /** Hash of raw bytes with the byte at the given offset treated as zero */
+    static std::uint64_t Hash(std::span<const std::uint8_t> content, std::size_t skip_offset);
+
+    /** Check the slot selected by the hash for the tag and remember the tag otherwise */
+    bool IsDuplicate(std::uint64_t hash, std::uint64_t tag, std::chrono::steady_clock::time_point now);
+
+private:
+    std::chrono::steady_clock::duration window_;
+    std::chrono::steady_clock::time_point start_;
+    std::size_t mask_;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
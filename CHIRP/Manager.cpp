@@ -1,42 +1,57 @@
 #include "Manager.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <chrono>
+#include <deque>
 #include <functional>
 #include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
 #include <utility>
+#include <vector>
 
-#include <iostream>
-
-#include "CHIRP/exceptions.hpp"
 
 using namespace cnstln::CHIRP;
-using namespace std::literals::chrono_literals;
 
-bool RegisteredService::operator<(const RegisteredService& other) const {
-    // Sort first by service id
-    auto ord_id = std::to_underlying(identifier) <=> std::to_underlying(other.identifier);
-    if (std::is_lt(ord_id)) {
-        return true;
+namespace {
+    /** Index of a service identifier in per-service arrays */
+    std::size_t service_index(ServiceIdentifier service_id) {
+        return static_cast<std::size_t>(std::to_underlying(service_id) - std::to_underlying(CONTROL));
     }
-    if (std::is_gt(ord_id)) {
-        return false;
+
+    /** Key identifying a discovered service for ordered callback dispatch */
+    std::size_t service_key(const DiscoveredService& service) {
+        const auto id = static_cast<std::size_t>(std::to_underlying(service.identifier));
+        return std::hash<MD5Hash>()(service.host_id) ^ (id << 16U) ^ service.port;
     }
-    // Then by port
-    return port < other.port;
-}
 
-bool DiscoveredService::operator<(const DiscoveredService& other) const {
-    // Ignore IP when sorting, we only care about the host
-    auto ord_host_id = host_id <=> other.host_id;
-    if (std::is_lt(ord_host_id)) {
+    /** Replace a copy-on-write callback list by a modified copy, the modification returns false to keep the list */
+    template <typename Entry, typename F>
+    bool modify_callbacks(std::atomic<std::shared_ptr<const std::vector<Entry>>>& callbacks, F&& modify) {
+        auto modified = std::make_shared<std::vector<Entry>>(*callbacks.load(std::memory_order_relaxed));
+        if (!modify(*modified)) {
+            return false;
+        }
+        callbacks.store(std::move(modified), std::memory_order_release);
         return true;
     }
-    if (std::is_gt(ord_host_id)) {
-        return false;
+
+    /** Single unbound interface for a broadcast address */
+    std::vector<NetworkInterface> broadcast_interfaces(asio::ip::address brd_address) {
+        std::vector<NetworkInterface> interfaces {};
+        interfaces.emplace_back(std::string(), asio::ip::address(), std::move(brd_address));
+        return interfaces;
     }
-    // Same as RegisteredService::operator<
+} // namespace
+
+bool RegisteredService::operator<(const RegisteredService& other) const {
+    // Sort first by service id
     auto ord_id = std::to_underlying(identifier) <=> std::to_underlying(other.identifier);
     if (std::is_lt(ord_id)) {
         return true;
@@ -44,6 +59,7 @@ bool DiscoveredService::operator<(const DiscoveredService& other) const {
     if (std::is_gt(ord_id)) {
         return false;
     }
+    // Then by port
     return port < other.port;
 }
 
@@ -60,25 +76,306 @@ bool DiscoverCallbackEntry::operator<(const DiscoverCallbackEntry& other) const
     return std::to_underlying(service_id) < std::to_underlying(other.service_id);
 }
 
-Manager::Manager(asio::ip::address brd_address, asio::ip::address any_address, std::string_view group_name, std::string_view host_name)
-  : receiver_(any_address), sender_(brd_address), group_id_(MD5Hash(group_name)), host_id_(MD5Hash(host_name)) {}
+bool DiscoverBatchCallbackEntry::operator<(const DiscoverBatchCallbackEntry& other) const {
+    // Same as DiscoverCallbackEntry::operator<
+    auto ord_callback = reinterpret_cast<std::uintptr_t>(callback) <=> reinterpret_cast<std::uintptr_t>(other.callback);
+    if (std::is_lt(ord_callback)) {
+        return true;
+    }
+    if (std::is_gt(ord_callback)) {
+        return false;
+    }
+    return std::to_underlying(service_id) < std::to_underlying(other.service_id);
+}
+
+struct Manager::PendingDiscoveryEvents {
+    /** Mutex for thread-safe access to the queue, the window and the timer */
+    std::mutex mutex;
+    /** Manager owning the queue, nullptr after the manager is destroyed */
+    Manager* manager {nullptr};
+    /** Queued discovery events */
+    std::vector<DiscoveryEvent> events;
+    /** Coalescing window */
+    std::chrono::steady_clock::duration window {std::chrono::steady_clock::duration::zero()};
+    /** Whether the coalescing timer is armed */
+    bool flush_scheduled {false};
+};
+
+struct Manager::ReplySchedule {
+    /** Mutex for thread-safe access to the schedule and the reply timers */
+    std::mutex mutex;
+    /** Manager owning the schedule, nullptr after the manager is destroyed */
+    Manager* manager {nullptr};
+    /** Window in which REQUESTs are not replied to after a reply */
+    std::chrono::steady_clock::duration window {std::chrono::steady_clock::duration::zero()};
+    /** Maximum random delay of a reply */
+    std::chrono::steady_clock::duration jitter {std::chrono::steady_clock::duration::zero()};
+    /**
+     * Time since epoch of the steady clock of the last broadcast of all OFFERs per service identifier
+     *
+     * Atomic since it is recorded by every path sending OFFERs, some of which do not lock the schedule.
+     */
+    std::array<std::atomic<std::chrono::steady_clock::rep>, SERVICE_IDENTIFIER_COUNT> last_offers {};
+    /** Whether a reply is scheduled per service identifier */
+    std::array<bool, SERVICE_IDENTIFIER_COUNT> scheduled {};
+    /** Random generator for the jitter */
+    std::minstd_rand random_generator {std::random_device()()};
+};
+
+struct Manager::Liveness {
+    /** Mutex for thread-safe access to the configuration and the timers */
+    std::mutex mutex;
+    /** Manager owning the configuration, nullptr after the manager is destroyed */
+    Manager* manager {nullptr};
+    /** Interval between announcements */
+    std::chrono::steady_clock::duration announce_interval {std::chrono::steady_clock::duration::zero()};
+    /** Interval between ticks of the expiry wheel */
+    std::chrono::steady_clock::duration expiry_resolution {std::chrono::steady_clock::duration::zero()};
+    /** Whether the expiry timer is armed, it is only armed while expiry checks are scheduled */
+    bool expiry_check_armed {false};
+    /** Time after the start until which services loaded from the discovery cache need to be confirmed */
+    std::chrono::steady_clock::duration confirm_timeout {std::chrono::steady_clock::duration::zero()};
+};
+
+struct Manager::DiscoverWaiter {
+    DiscoverWaiter(asio::io_context& io_context, std::function<void(asio::error_code, DiscoveredService)> handler)
+      : timer(io_context), handler(std::move(handler)) {}
+    /** Complete the operation, only the first call executes the handler */
+    void Complete(asio::error_code ec, const DiscoveredService& service) {
+        if (!completed.test_and_set()) {
+            std::exchange(handler, nullptr)(ec, service);
+        }
+    }
+    /** Timer for the timeout, guarded by the mutex of the manager */
+    asio::steady_timer timer;
+    /** Type-erased completion handler */
+    std::function<void(asio::error_code, DiscoveredService)> handler;
+    /** Whether the operation was completed by a discovery, a timeout or the destruction of the manager */
+    std::atomic_flag completed;
+};
+
+struct DiscoverySubscription::State {
+    /** Complete a pending handler with the event, or queue the event */
+    void Push(const DiscoveryEvent& event) {
+        const std::lock_guard lock {mutex};
+        if (handler) {
+            std::exchange(handler, nullptr)({}, event);
+        }
+        else {
+            events.push_back(event);
+        }
+    }
+    /** Close the subscription, aborting a pending handler */
+    void Close() {
+        const std::lock_guard lock {mutex};
+        closed = true;
+        if (handler) {
+            std::exchange(handler, nullptr)(asio::error::operation_aborted, {});
+        }
+    }
+    /** Mutex for thread-safe access to the queue and the handler */
+    std::mutex mutex;
+    /** Queued events */
+    std::deque<DiscoveryEvent> events;
+    /** Pending handler of DiscoverySubscription::AsyncNext, empty if none */
+    Handler handler;
+    /** Whether the subscription or the manager was destroyed */
+    bool closed {false};
+};
+
+DiscoverySubscription::DiscoverySubscription(std::shared_ptr<State> state, asio::io_context::executor_type executor)
+  : state_(std::move(state)), executor_(std::move(executor)) {}
+
+DiscoverySubscription::~DiscoverySubscription() {
+    // Moved-from subscriptions have no state
+    if (state_) {
+        state_->Close();
+    }
+}
+
+void DiscoverySubscription::Wait(const std::shared_ptr<State>& state, Handler handler) {
+    const std::lock_guard lock {state->mutex};
+    if (!state->events.empty()) {
+        auto event = std::move(state->events.front());
+        state->events.pop_front();
+        handler({}, std::move(event));
+    }
+    else if (state->closed) {
+        handler(asio::error::operation_aborted, {});
+    }
+    else {
+        state->handler = std::move(handler);
+    }
+}
+
+Manager::Manager(std::unique_ptr<asio::io_context> own_io_context, asio::io_context* external_io_context,
+                 asio::ip::address own_demultiplexer_address, Demultiplexer* external_demultiplexer, Transport* transport,
+                 std::vector<NetworkInterface> interfaces, std::string_view group_name, std::string_view host_name,
+                 const SocketOptions& socket_options)
+  : own_io_context_(std::move(own_io_context)),
+    io_context_(external_io_context != nullptr ? *external_io_context : *own_io_context_),
+    own_demultiplexer_(external_demultiplexer != nullptr ? nullptr
+                       : transport != nullptr     ? std::make_unique<Demultiplexer>(io_context_, *transport)
+                                                  : std::make_unique<Demultiplexer>(io_context_, std::move(own_demultiplexer_address), socket_options)),
+    demultiplexer_(external_demultiplexer != nullptr ? *external_demultiplexer : *own_demultiplexer_),
+    sender_(transport != nullptr ? nullptr : std::make_unique<BroadcastSend>(io_context_, interfaces, socket_options)),
+    transport_(transport), group_id_(MD5Hash::Intern(group_name)),
+    host_id_(MD5Hash::Intern(host_name)), message_builder_(group_id_, host_id_),
+    discover_batch_timer_(io_context_),
+    pending_discovery_events_(std::make_shared<PendingDiscoveryEvents>()),
+    reply_schedule_(std::make_shared<ReplySchedule>()), announce_timer_(io_context_), expiry_timer_(io_context_),
+    tentative_timer_(io_context_), liveness_(std::make_shared<Liveness>()), metrics_(std::make_shared<Metrics>()),
+    callback_dispatcher_(own_io_context_ ? std::make_unique<CallbackDispatcher>()
+                                         : std::make_unique<CallbackDispatcher>(io_context_.get_executor())) {
+    pending_discovery_events_->manager = this;
+    reply_schedule_->manager = this;
+    liveness_->manager = this;
+    reply_timers_.reserve(SERVICE_IDENTIFIER_COUNT);
+    for (std::size_t n = 0; n < SERVICE_IDENTIFIER_COUNT; ++n) {
+        reply_timers_.emplace_back(io_context_);
+    }
+    discovered_services_snapshot_.store(std::make_shared<const std::vector<DiscoveredService>>());
+    for (std::size_t n = 0; n < SERVICE_IDENTIFIER_COUNT; ++n) {
+        discover_callbacks_[n].store(std::make_shared<const std::vector<DiscoverCallbackEntry>>());
+        discover_batch_callbacks_[n].store(std::make_shared<const std::vector<DiscoverBatchCallbackEntry>>());
+    }
+}
+
+Manager::Manager(asio::ip::address brd_address, asio::ip::address any_address, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(std::make_unique<asio::io_context>(), nullptr, std::move(any_address), nullptr, nullptr, broadcast_interfaces(std::move(brd_address)), group_name, host_name, socket_options) {}
+
+Manager::Manager(std::string_view brd_ip, std::string_view any_ip, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(asio::ip::make_address(brd_ip), asio::ip::make_address(any_ip), group_name, host_name, socket_options) {}
+
+Manager::Manager(asio::io_context& io_context, asio::ip::address brd_address, asio::ip::address any_address, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(nullptr, &io_context, std::move(any_address), nullptr, nullptr, broadcast_interfaces(std::move(brd_address)), group_name, host_name, socket_options) {}
+
+Manager::Manager(asio::io_context& io_context, std::string_view brd_ip, std::string_view any_ip, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(io_context, asio::ip::make_address(brd_ip), asio::ip::make_address(any_ip), group_name, host_name, socket_options) {}
+
+Manager::Manager(Demultiplexer& demultiplexer, asio::ip::address brd_address, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(nullptr, &demultiplexer.GetIOContext(), {}, &demultiplexer, nullptr, broadcast_interfaces(std::move(brd_address)), group_name, host_name, socket_options) {}
+
+Manager::Manager(Demultiplexer& demultiplexer, std::string_view brd_ip, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(demultiplexer, asio::ip::make_address(brd_ip), group_name, host_name, socket_options) {}
 
-Manager::Manager(std::string_view brd_ip, std::string_view any_ip, std::string_view group_name, std::string_view host_name)
-  : Manager(asio::ip::make_address(brd_ip), asio::ip::make_address(any_ip), group_name, host_name) {}
+Manager::Manager(std::span<const NetworkInterface> interfaces, asio::ip::address any_address, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(std::make_unique<asio::io_context>(), nullptr, std::move(any_address), nullptr, nullptr, {interfaces.begin(), interfaces.end()}, group_name, host_name, socket_options) {}
+
+Manager::Manager(asio::io_context& io_context, std::span<const NetworkInterface> interfaces, asio::ip::address any_address, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(nullptr, &io_context, std::move(any_address), nullptr, nullptr, {interfaces.begin(), interfaces.end()}, group_name, host_name, socket_options) {}
+
+Manager::Manager(Demultiplexer& demultiplexer, std::span<const NetworkInterface> interfaces, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(nullptr, &demultiplexer.GetIOContext(), {}, &demultiplexer, nullptr, {interfaces.begin(), interfaces.end()}, group_name, host_name, socket_options) {}
+
+Manager::Manager(MulticastTag /*multicast*/, asio::ip::address any_address, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(std::make_unique<asio::io_context>(), nullptr, any_address, nullptr, nullptr,
+            broadcast_interfaces(MulticastAddress(MD5Hash::Intern(group_name), any_address.is_v6())), group_name, host_name, socket_options) {
+    own_demultiplexer_->EnableMulticast(any_address.is_v6());
+}
+
+Manager::Manager(MulticastTag /*multicast*/, Demultiplexer& demultiplexer, bool ipv6, std::string_view group_name, std::string_view host_name, const SocketOptions& socket_options)
+  : Manager(nullptr, &demultiplexer.GetIOContext(), {}, &demultiplexer, nullptr,
+            broadcast_interfaces(MulticastAddress(MD5Hash::Intern(group_name), ipv6)), group_name, host_name, socket_options) {}
+
+Manager::Manager(Transport& transport, std::string_view group_name, std::string_view host_name)
+  : Manager(std::make_unique<asio::io_context>(), nullptr, {}, nullptr, &transport, {}, group_name, host_name, {}) {}
+
+Manager::Manager(asio::io_context& io_context, Transport& transport, std::string_view group_name, std::string_view host_name)
+  : Manager(nullptr, &io_context, {}, nullptr, &transport, {}, group_name, host_name, {}) {}
+
+Manager::Manager(Demultiplexer& demultiplexer, Transport& transport, std::string_view group_name, std::string_view host_name)
+  : Manager(nullptr, &demultiplexer.GetIOContext(), {}, &demultiplexer, &transport, {}, group_name, host_name, {}) {}
 
 Manager::~Manager() {
-    // First stop Run function
+    // First stop receiving, this also waits for a running handler when using an external IO context
+    demultiplexer_.UnregisterManager(this);
+    if (own_demultiplexer_) {
+        own_demultiplexer_->Stop();
+    }
+    // Drop queued discovery events, a pending timer handler does not access the manager anymore
+    {
+        const std::lock_guard pending_lock {pending_discovery_events_->mutex};
+        pending_discovery_events_->manager = nullptr;
+        discover_batch_timer_.cancel();
+    }
+    // Drop scheduled replies, a pending timer handler does not access the manager anymore
+    {
+        const std::lock_guard reply_schedule_lock {reply_schedule_->mutex};
+        reply_schedule_->manager = nullptr;
+        for (auto& timer : reply_timers_) {
+            timer.cancel();
+        }
+    }
+    // Stop announcements and expiry, a pending timer handler does not access the manager anymore
+    {
+        const std::lock_guard liveness_lock {liveness_->mutex};
+        liveness_->manager = nullptr;
+        announce_timer_.cancel();
+        expiry_timer_.cancel();
+        tentative_timer_.cancel();
+    }
+    // Abort pending asynchronous discoveries and close subscriptions
+    {
+        const std::lock_guard discover_waiters_lock {discover_waiters_mutex_};
+        for (auto& waiters : discover_waiters_) {
+            for (auto& waiter : waiters) {
+                waiter->timer.cancel();
+                waiter->Complete(asio::error::operation_aborted, {});
+            }
+            waiters.clear();
+        }
+        for (auto& subscriptions : discovery_subscriptions_) {
+            for (auto& subscription : subscriptions) {
+                subscription->Close();
+            }
+            subscriptions.clear();
+        }
+    }
+    // Then stop Run function
     run_thread_.request_stop();
     if (run_thread_.joinable()) {
         run_thread_.join();
     }
     // Now unregister all services
     UnregisterServices();
+    // Persist discovered services for the next start
+    if (discovery_cache_) {
+        StoreDiscoveryCache();
+    }
 }
 
 void Manager::Start() {
-    // jthread immediatly starts on construction
-    run_thread_ = std::jthread(std::bind_front(&Manager::Run, this));
+    // Callback dispatcher is used without locking from now on
+    started_ = true;
+    // Send asynchronously, falling back to synchronous sending if the queue overflows to never lose messages
+    if (sender_ && !sender_->AsyncSendEnabled()) {
+        sender_->EnableAsyncSend(1024, OverflowPolicy::SEND_SYNC);
+    }
+    // Register in demultiplexer and arm continuous receive before starting the run loop
+    demultiplexer_.RegisterManager(this);
+    if (own_demultiplexer_) {
+        own_demultiplexer_->Start();
+    }
+    // Arm liveness timers if enabled
+    {
+        const std::lock_guard liveness_lock {liveness_->mutex};
+        if (liveness_->announce_interval != std::chrono::steady_clock::duration::zero()) {
+            ScheduleAnnouncement();
+        }
+        if (discovery_cache_) {
+            LoadDiscoveryCache();
+        }
+        // Services discovered since registering in the demultiplexer or loaded from the cache need expiry checks
+        ScheduleExpiryCheck();
+    }
+    // Only run background thread when owning the IO context
+    if (own_io_context_) {
+        // Restart before the thread starts, such that a stop requested before the thread runs is not reset
+        own_io_context_->restart();
+        // jthread immediatly starts on construction
+        run_thread_ = std::jthread(std::bind_front(&Manager::Run, this));
+    }
 }
 
 bool Manager::RegisterService(ServiceIdentifier service_id, Port port) {
@@ -87,13 +384,23 @@ bool Manager::RegisterService(ServiceIdentifier service_id, Port port) {
     std::unique_lock registered_services_lock {registered_services_mutex_};
     const auto insert_ret = registered_services_.insert(service);
     const bool actually_inserted = insert_ret.second;
+    if (!actually_inserted) {
+        return false;
+    }
+    // Assemble OFFER once, it is replayed for every REQUEST
+    const auto asm_msg = message_builder_.Build(OFFER, service_id, port);
+    auto& offers = registered_offers_[service_index(service_id)];
+    offers.push_back(asm_msg);
+    // OFFER covers a REQUEST for the service identifier only if it is the only registered service
+    const auto all_offers = offers.size() == 1;
 
     // Lock not needed anymore
     registered_services_lock.unlock();
-    if (actually_inserted) {
-        SendMessage(OFFER, service);
+    SendMessages({&asm_msg, 1});
+    if (all_offers) {
+        RecordOffersSent(service_id);
     }
-    return actually_inserted;
+    return true;
 }
 
 bool Manager::UnregisterService(ServiceIdentifier service_id, Port port) {
@@ -101,21 +408,34 @@ bool Manager::UnregisterService(ServiceIdentifier service_id, Port port) {
 
     std::unique_lock registered_services_lock {registered_services_mutex_};
     const auto erase_ret = registered_services_.erase(service);
-    bool actually_erased = erase_ret > 0 ? true : false;
+    if (erase_ret == 0) {
+        return false;
+    }
+    // Remove pre-assembled OFFER, which only differs from a DEPART in the message type
+    auto& offers = registered_offers_[service_index(service_id)];
+    const auto offer_it = std::ranges::find(offers, message_builder_.Build(OFFER, service_id, port));
+    const auto asm_msg = MessageBuilder::WithType(*offer_it, DEPART);
+    *offer_it = offers.back();
+    offers.pop_back();
 
     // Lock not needed anymore
     registered_services_lock.unlock();
-    if (actually_erased) {
-        SendMessage(DEPART, service);
-    }
-    return actually_erased;
+    SendMessages({&asm_msg, 1});
+    return true;
 }
 
 void Manager::UnregisterServices() {
     const std::lock_guard registered_services_lock {registered_services_mutex_};
-    for (auto service : registered_services_) {
-        SendMessage(DEPART, service);
+    // Send DEPARTs for all services in a single batch
+    std::vector<AssembledMessage> asm_msgs {};
+    asm_msgs.reserve(registered_services_.size());
+    for (auto& offers : registered_offers_) {
+        std::ranges::transform(offers, std::back_inserter(asm_msgs), [](const auto& offer) {
+            return MessageBuilder::WithType(offer, DEPART);
+        });
+        offers.clear();
     }
+    SendMessages(asm_msgs);
     registered_services_.clear();
 }
 
@@ -124,48 +444,189 @@ std::set<RegisteredService> Manager::GetRegisteredServices() {
     return registered_services_;
 }
 
+void Manager::SetReplyScheduling(std::chrono::steady_clock::duration window, std::chrono::steady_clock::duration jitter) {
+    const std::lock_guard reply_schedule_lock {reply_schedule_->mutex};
+    reply_schedule_->window = window;
+    reply_schedule_->jitter = jitter;
+}
+
+void Manager::SetAnnounceInterval(std::chrono::steady_clock::duration interval) {
+    const std::lock_guard liveness_lock {liveness_->mutex};
+    liveness_->announce_interval = interval;
+}
+
+void Manager::SetDiscoveryTTL(std::chrono::steady_clock::duration ttl) {
+    const std::lock_guard liveness_lock {liveness_->mutex};
+    const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+    discovery_ttl_ = ttl;
+    liveness_->expiry_resolution = std::chrono::steady_clock::duration::zero();
+    if (ttl != std::chrono::steady_clock::duration::zero()) {
+        liveness_->expiry_resolution = std::max<std::chrono::steady_clock::duration>(ttl / 16, std::chrono::milliseconds(1));
+    }
+    expiry_wheel_.Reset(liveness_->expiry_resolution);
+}
+
+void Manager::SetDiscoveryCache(std::filesystem::path directory, std::chrono::steady_clock::duration confirm_timeout) {
+    const std::lock_guard liveness_lock {liveness_->mutex};
+    discovery_cache_.emplace(std::move(directory), group_id_);
+    liveness_->confirm_timeout = confirm_timeout;
+}
+
+bool Manager::StoreDiscoveryCache() {
+    if (!discovery_cache_) {
+        return false;
+    }
+    std::vector<DiscoveredService> services {};
+    {
+        const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+        services = discovered_services_.GetAll();
+        if (!tentative_services_.Empty()) {
+            std::erase_if(services, [&](const auto& service) { return tentative_services_.Contains(service); });
+        }
+    }
+    return discovery_cache_->Store(services);
+}
+
+bool Manager::SetCallbackThreads(std::size_t threads) {
+    if (started_) {
+        return false;
+    }
+    // Waits for callbacks dispatched by the previous dispatcher
+    callback_dispatcher_.reset();
+    callback_dispatcher_ = threads > 0 || own_io_context_ ? std::make_unique<CallbackDispatcher>(threads)
+                                                          : std::make_unique<CallbackDispatcher>(io_context_.get_executor());
+    return true;
+}
+
 bool Manager::RegisterDiscoverCallback(DiscoverCallback* callback, ServiceIdentifier service_id, std::any user_data) {
     const std::lock_guard discover_callbacks_lock {discover_callbacks_mutex_};
-    const auto insert_ret = discover_callbacks_.emplace(callback, service_id, user_data);
-
-    // Return if actually inserted
-    return insert_ret.second;
+    return modify_callbacks(discover_callbacks_[service_index(service_id)], [&](auto& cb_entries) {
+        // Only insert if callback not yet registered for this service
+        if (std::ranges::find(cb_entries, callback, &DiscoverCallbackEntry::callback) != cb_entries.end()) {
+            return false;
+        }
+        cb_entries.emplace_back(callback, service_id, std::move(user_data));
+        return true;
+    });
 }
 
 bool Manager::UnregisterDiscoverCallback(DiscoverCallback* callback, ServiceIdentifier service_id) {
     const std::lock_guard discover_callbacks_lock {discover_callbacks_mutex_};
-    const auto erase_ret = discover_callbacks_.erase({callback, service_id, {}});
+    return modify_callbacks(discover_callbacks_[service_index(service_id)], [&](auto& cb_entries) {
+        return std::erase_if(cb_entries, [&](const auto& cb_entry) { return cb_entry.callback == callback; }) > 0;
+    });
+}
 
-    // Return if actually erased
-    return erase_ret > 0;
+bool Manager::RegisterDiscoverBatchCallback(DiscoverBatchCallback* callback, ServiceIdentifier service_id, void* user_data) {
+    const std::lock_guard discover_callbacks_lock {discover_callbacks_mutex_};
+    return modify_callbacks(discover_batch_callbacks_[service_index(service_id)], [&](auto& cb_entries) {
+        // Same as RegisterDiscoverCallback
+        if (std::ranges::find(cb_entries, callback, &DiscoverBatchCallbackEntry::callback) != cb_entries.end()) {
+            return false;
+        }
+        cb_entries.emplace_back(callback, service_id, user_data);
+        return true;
+    });
+}
+
+bool Manager::UnregisterDiscoverBatchCallback(DiscoverBatchCallback* callback, ServiceIdentifier service_id) {
+    const std::lock_guard discover_callbacks_lock {discover_callbacks_mutex_};
+    return modify_callbacks(discover_batch_callbacks_[service_index(service_id)], [&](auto& cb_entries) {
+        return std::erase_if(cb_entries, [&](const auto& cb_entry) { return cb_entry.callback == callback; }) > 0;
+    });
+}
+
+void Manager::SetDiscoverBatchWindow(std::chrono::steady_clock::duration window) {
+    const std::lock_guard pending_lock {pending_discovery_events_->mutex};
+    pending_discovery_events_->window = window;
 }
 
 void Manager::UnregisterDiscoverCallbacks() {
     const std::lock_guard discover_callbacks_lock {discover_callbacks_mutex_};
-    discover_callbacks_.clear();
+    for (std::size_t n = 0; n < SERVICE_IDENTIFIER_COUNT; ++n) {
+        discover_callbacks_[n].store(std::make_shared<const std::vector<DiscoverCallbackEntry>>(), std::memory_order_release);
+        discover_batch_callbacks_[n].store(std::make_shared<const std::vector<DiscoverBatchCallbackEntry>>(),
+                                           std::memory_order_release);
+    }
 }
 
 void Manager::ForgetDiscoveredServices() {
     const std::lock_guard discovered_services_lock {discovered_services_mutex_};
-    discovered_services_.clear();
+    discovered_services_.Clear();
+    tentative_services_.Clear();
+    expiry_wheel_.Reset(expiry_wheel_.Resolution());
+    PublishDiscoveredServices();
+}
+
+std::shared_ptr<const std::vector<DiscoveredService>> Manager::GetDiscoveredServicesSnapshot() const {
+    return discovered_services_snapshot_.load(std::memory_order_acquire);
+}
+
+MetricsSnapshot Manager::GetMetricsSnapshot() const {
+    auto snapshot = metrics_->Snapshot();
+    if (sender_) {
+        snapshot += sender_->GetMetrics().Snapshot();
+    }
+    if (own_demultiplexer_) {
+        snapshot += own_demultiplexer_->GetMetricsSnapshot();
+    }
+    return snapshot;
 }
 
 std::vector<DiscoveredService> Manager::GetDiscoveredServices() {
-    std::vector<DiscoveredService> ret {};
-    const std::lock_guard discovered_services_lock {discovered_services_mutex_};
-    std::copy(discovered_services_.begin(), discovered_services_.end(), std::back_inserter(ret));
-    return ret;
+    return *GetDiscoveredServicesSnapshot();
 }
 
 std::vector<DiscoveredService> Manager::GetDiscoveredServices(ServiceIdentifier service_id) {
-    std::vector<DiscoveredService> ret {};
+    // Snapshot is ordered by service identifier
+    const auto snapshot = GetDiscoveredServicesSnapshot();
+    const auto services = std::ranges::equal_range(*snapshot, service_id, {}, &DiscoveredService::identifier);
+    return {services.begin(), services.end()};
+}
+
+void Manager::PublishDiscoveredServices() {
+    auto snapshot = std::make_shared<const std::vector<DiscoveredService>>(discovered_services_.GetAll());
+    discovered_services_snapshot_.store(std::move(snapshot), std::memory_order_release);
+    discovered_services_changed_ = false;
+}
+
+void Manager::AddDiscoverWaiter(ServiceIdentifier service_id, std::chrono::steady_clock::duration timeout,
+                                std::function<void(asio::error_code, DiscoveredService)> handler) {
+    // Keep discovered services locked until the waiter is registered such that no OFFER is missed
     const std::lock_guard discovered_services_lock {discovered_services_mutex_};
-    for (const auto& discovered_service : discovered_services_) {
-        if (discovered_service.identifier == service_id) {
-            ret.push_back(discovered_service);
-        }
+    const auto services = discovered_services_.Get(service_id);
+    if (!services.empty()) {
+        handler({}, services.front());
+        return;
     }
-    return ret;
+
+    auto waiter = std::make_shared<DiscoverWaiter>(io_context_, std::move(handler));
+    const std::lock_guard discover_waiters_lock {discover_waiters_mutex_};
+    auto& waiters = discover_waiters_[service_index(service_id)];
+    // Drop waiters which timed out
+    std::erase_if(waiters, [](const auto& other) { return other->completed.test(); });
+    waiter->timer.expires_after(timeout);
+    waiter->timer.async_wait([waiter](const asio::error_code& ec) {
+        if (!ec) {
+            waiter->Complete(asio::error::timed_out, {});
+        }
+    });
+    waiters.emplace_back(std::move(waiter));
+    discover_waiters_active_[service_index(service_id)].store(true, std::memory_order_release);
+}
+
+DiscoverySubscription Manager::SubscribeDiscovery(ServiceIdentifier service_id) {
+    auto state = std::make_shared<DiscoverySubscription::State>();
+    const std::lock_guard discover_waiters_lock {discover_waiters_mutex_};
+    auto& subscriptions = discovery_subscriptions_[service_index(service_id)];
+    // Drop destroyed subscriptions
+    std::erase_if(subscriptions, [](const auto& other) {
+        const std::lock_guard lock {other->mutex};
+        return other->closed;
+    });
+    subscriptions.push_back(state);
+    discover_waiters_active_[service_index(service_id)].store(true, std::memory_order_release);
+    return {std::move(state), GetExecutor()};
 }
 
 void Manager::SendRequest(ServiceIdentifier service) {
@@ -173,87 +634,401 @@ void Manager::SendRequest(ServiceIdentifier service) {
 }
 
 void Manager::SendMessage(MessageType type, RegisteredService service) {
-    const auto asm_msg = Message(type, group_id_, host_id_, service.identifier, service.port).Assemble();
-    sender_.SendBroadcast(asm_msg.data(), asm_msg.size());
+    const auto asm_msg = message_builder_.Build(type, service.identifier, service.port);
+    SendMessages({&asm_msg, 1});
 }
 
-void Manager::Run(std::stop_token stop_token) {
-    while (!stop_token.stop_requested()) {
-        try {
-            const auto raw_msg_opt = receiver_.AsyncRecvBroadcast(100ms);
-
-            // Check for timeout
-            if (!raw_msg_opt.has_value()) {
-                continue;
-            }
+void Manager::SendMessages(std::span<const AssembledMessage> asm_msgs) {
+    if (transport_ != nullptr) {
+        transport_->Send(asm_msgs);
+        return;
+    }
+    if (!sender_->AsyncSendEnabled()) {
+        sender_->SendBroadcasts(asm_msgs);
+        return;
+    }
+    for (const auto& asm_msg : asm_msgs) {
+        sender_->AsyncSendBroadcast(asm_msg);
+    }
+}
 
-            const auto raw_msg = raw_msg_opt.value();
-            auto chirp_msg = Message(AssembledMessage(raw_msg.content));
+void Manager::HandleMessage(const Message& chirp_msg, const asio::ip::address& address) {
+    // Broadcasts from different groups and from self are already filtered by the demultiplexer
+    DiscoveredService discovered_service {address, chirp_msg.GetHostID(), chirp_msg.GetServiceIdentifier(), chirp_msg.GetPort()};
+    // Whether the first expiry check was scheduled, arming the expiry timer requires the liveness mutex
+    bool first_expiry_check = false;
 
-            if (chirp_msg.GetGroupID() != group_id_) {
-                // Broadcast from different group, ignore
-                continue;
+    switch (chirp_msg.GetType()) {
+    case REQUEST: {
+        metrics_->Increment(MetricCounter::REQUESTS_RECEIVED);
+        ScheduleReply(discovered_service.identifier);
+        break;
+    }
+    case OFFER: {
+        metrics_->Increment(MetricCounter::OFFERS_RECEIVED);
+        const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+        const Metrics::ScopedTimer lock_timer {*metrics_, MetricHistogram::LOCK_HOLD_TIME};
+        if (!tentative_services_.Empty() && tentative_services_.Erase(discovered_service)) {
+            ConfirmTentativeService(discovered_service);
+        }
+        std::chrono::steady_clock::time_point now {};
+        if (discovery_ttl_ != std::chrono::steady_clock::duration::zero()) {
+            now = std::chrono::steady_clock::now();
+            // Refresh known service, its expiry check is rescheduled lazily when it is due
+            auto* timestamps = discovered_services_.FindTimestamps(discovered_service);
+            if (timestamps != nullptr) {
+                timestamps->last_seen = now;
+                break;
             }
-            if (chirp_msg.GetHostID() == host_id_) {
-                // Broadcast from self, ignore
-                continue;
+        }
+        const auto expiry = now + discovery_ttl_;
+        if (discovered_services_.Insert(discovered_service, {now, expiry})) {
+            if (discovery_ttl_ != std::chrono::steady_clock::duration::zero()) {
+                first_expiry_check = expiry_wheel_.Empty();
+                expiry_wheel_.Schedule({discovered_service, expiry}, expiry);
             }
 
-            DiscoveredService discovered_service {raw_msg.address, chirp_msg.GetHostID(), chirp_msg.GetServiceIdentifier(), chirp_msg.GetPort()};
-
-            switch (chirp_msg.GetType()) {
-            case REQUEST: {
-                auto service_id = discovered_service.identifier;
-                const std::lock_guard registered_services_lock {registered_services_mutex_};
-                // Replay OFFERs for registered services with same service identifier
-                for (const auto& service : registered_services_) {
-                    if (service.identifier == service_id) {
-                        SendMessage(OFFER, service);
-                    }
-                }
-                break;
+            // Snapshot is published and callbacks are dispatched after the receive batch
+            discovered_services_changed_ = true;
+            discovery_events_.emplace_back(std::move(discovered_service), false);
+        }
+        break;
+    }
+    case DEPART: {
+        metrics_->Increment(MetricCounter::DEPARTS_RECEIVED);
+        const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+        const Metrics::ScopedTimer lock_timer {*metrics_, MetricHistogram::LOCK_HOLD_TIME};
+        if (!tentative_services_.Empty()) {
+            tentative_services_.Erase(discovered_service);
+        }
+        if (discovered_services_.Erase(discovered_service)) {
+
+            // Snapshot is published and callbacks are dispatched after the receive batch
+            discovered_services_changed_ = true;
+            discovery_events_.emplace_back(std::move(discovered_service), true);
+        }
+        break;
+    }
+    default: std::unreachable();
+    }
+
+    if (first_expiry_check) {
+        const std::lock_guard liveness_lock {liveness_->mutex};
+        ScheduleExpiryCheck();
+    }
+}
+
+void Manager::ScheduleReply(ServiceIdentifier service_id) {
+    auto& schedule = *reply_schedule_;
+    const std::lock_guard reply_schedule_lock {schedule.mutex};
+    if (schedule.window == std::chrono::steady_clock::duration::zero() &&
+        schedule.jitter == std::chrono::steady_clock::duration::zero()) {
+        SendOffers(service_id);
+        return;
+    }
+    const auto index = service_index(service_id);
+    if (schedule.scheduled[index]) {
+        // Coalesce into scheduled reply
+        return;
+    }
+    const std::chrono::steady_clock::time_point last_offers {
+        std::chrono::steady_clock::duration(schedule.last_offers[index].load(std::memory_order_relaxed))};
+    if (last_offers + schedule.window > std::chrono::steady_clock::now()) {
+        // OFFERs were just broadcast and thus seen by the requester
+        return;
+    }
+    schedule.scheduled[index] = true;
+    std::uniform_int_distribution<std::chrono::steady_clock::rep> jitter_distribution {0, schedule.jitter.count()};
+    reply_timers_[index].expires_after(std::chrono::steady_clock::duration(jitter_distribution(schedule.random_generator)));
+    reply_timers_[index].async_wait([state = reply_schedule_, service_id, index](const asio::error_code& ec) {
+        const std::lock_guard reply_schedule_lock {state->mutex};
+        state->scheduled[index] = false;
+        if (ec || state->manager == nullptr) {
+            return;
+        }
+        state->manager->SendOffers(service_id);
+    });
+}
+
+void Manager::SendOffers(ServiceIdentifier service_id) {
+    const std::lock_guard registered_services_lock {registered_services_mutex_};
+    // Replay pre-assembled OFFERs for registered services with same service identifier in a single batch
+    const auto& offers = registered_offers_[service_index(service_id)];
+    metrics_->Increment(MetricCounter::OFFERS_SENT, offers.size());
+    SendMessages(offers);
+    RecordOffersSent(service_id);
+}
+
+void Manager::RecordOffersSent(ServiceIdentifier service_id) {
+    reply_schedule_->last_offers[service_index(service_id)].store(
+        std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+void Manager::ScheduleAnnouncement() {
+    announce_timer_.expires_after(liveness_->announce_interval);
+    announce_timer_.async_wait([state = liveness_](const asio::error_code& ec) {
+        const std::lock_guard liveness_lock {state->mutex};
+        if (ec || state->manager == nullptr) {
+            return;
+        }
+        for (const auto service_id : {CONTROL, HEARTBEAT, MONITORING, DATA}) {
+            state->manager->SendOffers(service_id);
+        }
+        state->manager->ScheduleAnnouncement();
+    });
+}
+
+void Manager::ScheduleExpiryCheck() {
+    if (liveness_->expiry_check_armed || liveness_->expiry_resolution == std::chrono::steady_clock::duration::zero()) {
+        return;
+    }
+    {
+        // Idle managers do not tick, the timer is armed again when the first expiry check is scheduled
+        const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+        if (expiry_wheel_.Empty()) {
+            return;
+        }
+    }
+    liveness_->expiry_check_armed = true;
+    expiry_timer_.expires_after(liveness_->expiry_resolution);
+    expiry_timer_.async_wait([state = liveness_](const asio::error_code& ec) {
+        const std::lock_guard liveness_lock {state->mutex};
+        state->expiry_check_armed = false;
+        if (ec || state->manager == nullptr) {
+            return;
+        }
+        state->manager->ExpireDiscoveredServices();
+        state->manager->ScheduleExpiryCheck();
+    });
+}
+
+void Manager::ExpireDiscoveredServices() {
+    {
+        const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+        const auto now = std::chrono::steady_clock::now();
+        expiry_wheel_.Advance(now, [&](ScheduledExpiry&& scheduled) {
+            auto* timestamps = discovered_services_.FindTimestamps(scheduled.service);
+            if (timestamps == nullptr || timestamps->expiry != scheduled.expiry) {
+                // Service departed or was rediscovered with a new expiry check in the meantime
+                return;
             }
-            case OFFER: {
-                std::unique_lock discovered_services_lock {discovered_services_mutex_};
-                if (!discovered_services_.contains(discovered_service)) {
-                    discovered_services_.insert(discovered_service);
-
-                    // Unlock discovered_services_lock for user callback
-                    discovered_services_lock.unlock();
-                    // Acquire lock for discover_callbacks_
-                    const std::lock_guard discover_callbacks_lock {discover_callbacks_mutex_};
-                    // Loop over callback and run as detached threads
-                    for (const auto& cb_entry : discover_callbacks_) {
-                        if (cb_entry.service_id == discovered_service.identifier) {
-                            std::thread(cb_entry.callback, discovered_service, false, cb_entry.user_data).detach();
-                        }
-                    }
-                }
-                break;
+            const auto expiry = timestamps->last_seen + discovery_ttl_;
+            if (expiry > now) {
+                // Service was refreshed since the check was scheduled
+                timestamps->expiry = expiry;
+                expiry_wheel_.Schedule({std::move(scheduled.service), expiry}, expiry);
+                return;
             }
-            case DEPART: {
-                std::unique_lock discovered_services_lock {discovered_services_mutex_};
-                if (discovered_services_.contains(discovered_service)) {
-                    discovered_services_.erase(discovered_service);
-
-                    // Unlock discovered_services_lock for user callback
-                    discovered_services_lock.unlock();
-                    // Acquire lock for discover_callbacks_
-                    const std::lock_guard discover_callbacks_lock {discover_callbacks_mutex_};
-                    // Loop over callback and run as detached threads
-                    for (const auto& cb_entry : discover_callbacks_) {
-                        if (cb_entry.service_id == discovered_service.identifier) {
-                            std::thread(cb_entry.callback, discovered_service, true, cb_entry.user_data).detach();
-                        }
-                    }
-                }
-                break;
+            discovered_services_.Erase(scheduled.service);
+            discovered_services_changed_ = true;
+            discovery_events_.emplace_back(std::move(scheduled.service), true);
+        });
+    }
+    // Publish snapshot and dispatch callbacks as for a receive batch
+    FlushDiscoveryEvents();
+}
+
+void Manager::LoadDiscoveryCache() {
+    const auto services = discovery_cache_->Load();
+    if (services.empty()) {
+        return;
+    }
+    std::array<bool, SERVICE_IDENTIFIER_COUNT> requested {};
+    {
+        const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+        const auto now = std::chrono::steady_clock::now();
+        const auto expiry = now + discovery_ttl_;
+        for (const auto& service : services) {
+            // Skip services already discovered since the demultiplexer started
+            if (!discovered_services_.Insert(service, {now, expiry})) {
+                continue;
             }
-            default: std::unreachable();
+            tentative_services_.Insert(service);
+            if (discovery_ttl_ != std::chrono::steady_clock::duration::zero()) {
+                expiry_wheel_.Schedule({service, expiry}, expiry);
             }
+            discovered_services_changed_ = true;
+            discovery_events_.emplace_back(service, false);
+            requested[service_index(service.identifier)] = true;
+        }
+    }
+    // Publish snapshot and dispatch callbacks as for a receive batch
+    FlushDiscoveryEvents();
+
+    // Request the tentative services in a single batch, the OFFERs in reply confirm them
+    std::vector<AssembledMessage> requests {};
+    for (const auto service_id : {CONTROL, HEARTBEAT, MONITORING, DATA}) {
+        if (requested[service_index(service_id)]) {
+            requests.push_back(message_builder_.Build(REQUEST, service_id, 0));
+        }
+    }
+    SendMessages(requests);
+
+    tentative_timer_.expires_after(liveness_->confirm_timeout);
+    tentative_timer_.async_wait([state = liveness_](const asio::error_code& ec) {
+        const std::lock_guard liveness_lock {state->mutex};
+        if (ec || state->manager == nullptr) {
+            return;
+        }
+        state->manager->ExpireTentativeServices();
+    });
+}
+
+void Manager::ConfirmTentativeService(const DiscoveredService& service) {
+    // Rediscover service if the host changed its address since the snapshot was stored
+    const auto entries = discovered_services_.Get(service.identifier);
+    const auto entry_it = std::ranges::find_if(
+        entries, [&](const auto& entry) { return entry.host_id == service.host_id && entry.port == service.port; });
+    if (entry_it == entries.end() || entry_it->address == service.address) {
+        return;
+    }
+    auto stale_service = *entry_it;
+    discovered_services_.Erase(stale_service);
+    discovered_services_changed_ = true;
+    discovery_events_.emplace_back(std::move(stale_service), true);
+}
+
+void Manager::ExpireTentativeServices() {
+    {
+        const std::lock_guard discovered_services_lock {discovered_services_mutex_};
+        for (auto& service : tentative_services_.GetAll()) {
+            discovered_services_.Erase(service);
+            discovered_services_changed_ = true;
+            discovery_events_.emplace_back(std::move(service), true);
         }
-        catch (const DecodeError& error) {
+        tentative_services_.Clear();
+    }
+    // Publish snapshot and dispatch callbacks as for a receive batch
+    FlushDiscoveryEvents();
+}
+
+void Manager::NotifyDiscovery(const DiscoveredService& service, bool depart) {
+    const auto index = service_index(service.identifier);
+    // Dispatch callbacks of the service identifier, ordered per service
+    const auto cb_entries = discover_callbacks_[index].load(std::memory_order_acquire);
+    const auto key = service_key(service);
+    for (const auto& cb_entry : *cb_entries) {
+        callback_dispatcher_->Dispatch(
+            key, MeasuredTask([callback = cb_entry.callback, service, depart, user_data = cb_entry.user_data]() {
+                callback(service, depart, user_data);
+            }));
+    }
+    metrics_->Increment(MetricCounter::CALLBACKS_DISPATCHED, cb_entries->size());
+    // Queue event for batch callbacks, delivered in FlushDiscoveryEvents
+    if (!discover_batch_callbacks_[index].load(std::memory_order_acquire)->empty()) {
+        const std::lock_guard pending_lock {pending_discovery_events_->mutex};
+        pending_discovery_events_->events.emplace_back(service, depart);
+    }
+    // Complete asynchronous discoveries and deliver event to subscriptions
+    if (!discover_waiters_active_[index].load(std::memory_order_acquire)) {
+        return;
+    }
+    const std::lock_guard discover_waiters_lock {discover_waiters_mutex_};
+    auto& waiters = discover_waiters_[index];
+    if (!depart) {
+        for (auto& waiter : std::exchange(waiters, {})) {
+            waiter->timer.cancel();
+            waiter->Complete({}, service);
+        }
+    }
+    auto& subscriptions = discovery_subscriptions_[index];
+    for (const auto& subscription : subscriptions) {
+        subscription->Push({service, depart});
+    }
+    // Drop destroyed subscriptions
+    std::erase_if(subscriptions, [](const auto& subscription) {
+        const std::lock_guard lock {subscription->mutex};
+        return subscription->closed;
+    });
+    discover_waiters_active_[index].store(!waiters.empty() || !subscriptions.empty(), std::memory_order_release);
+}
+
+void Manager::FlushDiscoveryEvents() {
+    // Serialize flushes, such that concurrent flushes do not dispatch their events in a different order
+    const std::lock_guard flush_lock {flush_mutex_};
+    std::unique_lock discovered_services_lock {discovered_services_mutex_};
+    // Publish new snapshot only if something changed during the receive batch
+    if (discovered_services_changed_) {
+        PublishDiscoveredServices();
+    }
+    const auto events = std::exchange(discovery_events_, {});
+
+    // Unlock discovered_services_lock for user callbacks
+    discovered_services_lock.unlock();
+    for (const auto& event : events) {
+        NotifyDiscovery(event.service, event.depart);
+    }
+
+    auto& pending = *pending_discovery_events_;
+    const std::lock_guard pending_lock {pending.mutex};
+    if (pending.events.empty() || pending.flush_scheduled) {
+        return;
+    }
+    if (pending.window == std::chrono::steady_clock::duration::zero()) {
+        DispatchDiscoveryEvents(pending);
+        return;
+    }
+    // Collect events until the coalescing window expired
+    pending.flush_scheduled = true;
+    discover_batch_timer_.expires_after(pending.window);
+    discover_batch_timer_.async_wait([state = pending_discovery_events_](const asio::error_code& ec) {
+        const std::lock_guard pending_lock {state->mutex};
+        state->flush_scheduled = false;
+        if (ec || state->manager == nullptr) {
+            return;
+        }
+        state->manager->DispatchDiscoveryEvents(*state);
+    });
+}
+
+CallbackDispatcher::Task Manager::MeasuredTask(CallbackDispatcher::Task task) {
+    if constexpr (Metrics::ENABLED) {
+        return [metrics = metrics_, dispatched = Metrics::Now(), task = std::move(task)]() {
+            metrics->RecordSince(MetricHistogram::CALLBACK_QUEUE_DELAY, dispatched);
+            task();
+        };
+    }
+    return task;
+}
+
+void Manager::DispatchDiscoveryEvents(PendingDiscoveryEvents& pending) {
+    // Group events by service identifier, keeping the order of arrival
+    std::array<std::vector<DiscoveryEvent>, SERVICE_IDENTIFIER_COUNT> service_events {};
+    for (auto& event : std::exchange(pending.events, {})) {
+        service_events[service_index(event.service.identifier)].push_back(std::move(event));
+    }
+    for (std::size_t index = 0; index < SERVICE_IDENTIFIER_COUNT; ++index) {
+        if (service_events[index].empty()) {
             continue;
         }
+        const auto cb_entries = discover_batch_callbacks_[index].load(std::memory_order_acquire);
+        for (const auto& cb_entry : *cb_entries) {
+            // Keyed by callback such that invocations of the same callback are ordered
+            callback_dispatcher_->Dispatch(
+                std::hash<DiscoverBatchCallback*>()(cb_entry.callback),
+                MeasuredTask([callback = cb_entry.callback, cb_events = service_events[index], user_data = cb_entry.user_data]() {
+                    callback(cb_events, user_data);
+                }));
+        }
+        metrics_->Increment(MetricCounter::CALLBACKS_DISPATCHED, cb_entries->size());
+    }
+}
+
+void Manager::Run(std::stop_token stop_token) {
+    // When spin polling or using a transport, the receive runs outside of the IO context, which then only executes
+    // timers and callbacks
+    const auto spin_poll = own_demultiplexer_->ReceivesExternally();
+    std::optional<asio::executor_work_guard<asio::io_context::executor_type>> work_guard {};
+    if (spin_poll) {
+        work_guard.emplace(io_context_.get_executor());
     }
+    // Post stop to the IO context as soon as requested
+    const std::stop_callback stop_callback {stop_token, [this, spin_poll]() {
+                                                own_demultiplexer_->Stop();
+                                                if (spin_poll) {
+                                                    io_context_.stop();
+                                                }
+                                            }};
+    // Blocks until the continuous receive is stopped
+    io_context_.run();
 }
@@ -1,8 +1,17 @@
 #pragma once
 
 #include <any>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <set>
+#include <span>
 #include <string_view>
 #include <thread>
 #include <vector>
@@ -10,14 +19,31 @@
 #include "asio.hpp"
 
 #include "CHIRP/config.hpp"
-#include "CHIRP/BroadcastRecv.hpp"
 #include "CHIRP/BroadcastSend.hpp"
+#include "CHIRP/CallbackDispatcher.hpp"
+#include "CHIRP/Demultiplexer.hpp"
+#include "CHIRP/DiscoveredServiceTable.hpp"
+#include "CHIRP/DiscoveryCache.hpp"
 #include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/Multicast.hpp"
+#include "CHIRP/NetworkInterface.hpp"
 #include "CHIRP/protocol_info.hpp"
+#include "CHIRP/SocketOptions.hpp"
+#include "CHIRP/TimerWheel.hpp"
+#include "CHIRP/Transport.hpp"
 
 namespace cnstln {
 namespace CHIRP {
 
+/** Marker type to select the multicast constructors of the :cpp:class:`Manager` */
+struct MulticastTag {
+    explicit MulticastTag() = default;
+};
+
+/** Marker to select the multicast constructors of the :cpp:class:`Manager` */
+inline constexpr MulticastTag MULTICAST {};
+
 /** A service offered by the host and announced by the :cpp:class:`Manager` */
 struct RegisteredService {
     /** Service identifier of the offered service */
@@ -29,23 +55,6 @@ struct RegisteredService {
     CHIRP_API bool operator<(const RegisteredService& other) const;
 };
 
-/** A service discovered by the :cpp:class:`Manager` */
-struct DiscoveredService {
-    /** Address of the discovered service */
-    asio::ip::address address;
-
-    /** Host ID of the discovered service */
-    MD5Hash host_id;
-
-    /** Service identifier of the discovered service */
-    ServiceIdentifier identifier;
-
-    /** Port of the discovered service */
-    Port port;
-
-    CHIRP_API bool operator<(const DiscoveredService& other) const;
-};
-
 /**
  * Function signature for user callback
  *
@@ -54,8 +63,9 @@ struct DiscoveredService {
  * data passed to the callback (done via :cpp:func:`Manager::RegisterDiscoverCallback`).
  *
  * It is recommended to pass the user data wrapped in an atomic :cpp:class:`std::shared_ptr` since the callback is launched
- * asynchronously in a detached :cpp:class:`std::thread`. If the data is modified, it is recommended to use atomic types
- * when possible or a :cpp:class:`std::mutex` for locking to ensure thread-safe access.
+ * asynchronously via the :cpp:class:`CallbackDispatcher` of the manager. Callbacks for the same service are executed in
+ * order, but callbacks for different services might be executed concurrently. If the data is modified, it is recommended
+ * to use atomic types when possible or a :cpp:class:`std::mutex` for locking to ensure thread-safe access.
  */
 using DiscoverCallback = void(DiscoveredService service, bool depart, std::any user_data);
 
@@ -77,6 +87,134 @@ struct DiscoverCallbackEntry {
     CHIRP_API bool operator<(const DiscoverCallbackEntry& other) const;
 };
 
+/** Change of a discovered service delivered to a :cpp:type:`DiscoverBatchCallback` */
+struct DiscoveryEvent {
+    /** Discovered or departing service */
+    DiscoveredService service;
+
+    /** False if the service is newly discovered, true if the service is departing */
+    bool depart;
+};
+
+/**
+ * Function signature for batched user callback
+ *
+ * The first argument (``events``) contains all changes of discovered services with the registered service identifier
+ * gathered over one receive batch or coalescing window (see :cpp:func:`Manager::SetDiscoverBatchWindow`), in the order
+ * in which they were received. The span is only valid during the call. The second argument (``user_data``) is the
+ * pointer passed during registration (done via :cpp:func:`Manager::RegisterDiscoverBatchCallback`), which needs to
+ * outlive the registration.
+ *
+ * Batch callbacks are launched asynchronously via the :cpp:class:`CallbackDispatcher` of the manager. Invocations of the
+ * same callback are executed in order and never concurrently.
+ */
+using DiscoverBatchCallback = void(std::span<const DiscoveryEvent> events, void* user_data);
+
+/** Entry for a batched user callback in the :cpp:class:`Manager` */
+struct DiscoverBatchCallbackEntry {
+    /** Function pointer to a batch callback */
+    DiscoverBatchCallback* callback;
+
+    /** Service identifier of the service for which callbacks should be received */
+    ServiceIdentifier service_id;
+
+    /** Pointer to user data passed to the callback function */
+    void* user_data;
+
+    CHIRP_API bool operator<(const DiscoverBatchCallbackEntry& other) const;
+};
+
+/**
+ * Wrap a completion handler into a copyable function which posts the handler to its associated executor
+ *
+ * This is used by the asynchronous operations of the :cpp:class:`Manager` to store handlers of arbitrary completion
+ * tokens, e.g. ``asio::use_awaitable``, in non-template code. The returned function needs to be called at most once.
+ *
+ * @tparam Args Arguments of the completion signature after the error code
+ * @param handler Completion handler
+ * @param executor Executor used if the handler has no associated executor
+ * @return Function posting the handler with the given arguments
+ */
+template <typename... Args, typename Handler, typename Executor>
+std::function<void(asio::error_code, Args...)> PostingHandler(Handler handler, const Executor& executor) {
+    return [handler_executor = asio::get_associated_executor(handler, executor),
+            shared_handler = std::make_shared<Handler>(std::move(handler))](asio::error_code ec, Args... args) {
+        asio::post(handler_executor, [handler = std::move(*shared_handler), ec, ... args = std::move(args)]() mutable {
+            handler(ec, std::move(args)...);
+        });
+    };
+}
+
+/**
+ * Subscription to the discovery events of a service identifier
+ *
+ * Created via :cpp:func:`Manager::SubscribeDiscovery`. All changes of discovered services with the service identifier
+ * are queued from the subscription on, and are retrieved one at a time via :cpp:func:`AsyncNext`. This allows a
+ * coroutine to consume the events like an asynchronous generator:
+ *
+ * .. code-block:: cpp
+ *
+ *    auto subscription = manager.SubscribeDiscovery(DATA);
+ *    while(true) {
+ *        const auto event = co_await subscription.AsyncNext(asio::use_awaitable);
+ *        // ...
+ *    }
+ *
+ * The subscription needs to be destroyed before the manager.
+ */
+class DiscoverySubscription {
+public:
+    /** Type-erased completion handler of :cpp:func:`AsyncNext` */
+    using Handler = std::function<void(asio::error_code, DiscoveryEvent)>;
+
+    CHIRP_API ~DiscoverySubscription();
+
+    // No copy constructor/assignment
+    DiscoverySubscription(const DiscoverySubscription& other) = delete;
+    DiscoverySubscription& operator=(const DiscoverySubscription& other) = delete;
+    // Default move constructor/assignment
+    DiscoverySubscription(DiscoverySubscription&& other) noexcept = default;
+    DiscoverySubscription& operator=(DiscoverySubscription&& other) noexcept = default;
+
+    /**
+     * Asynchronously wait for the next discovery event
+     *
+     * Completes immediately if an event is already queued. Only one operation can be pending at a time. The completion
+     * signature is ``void(asio::error_code, DiscoveryEvent)``, where the error code is ``asio::error::operation_aborted``
+     * if the manager is destroyed.
+     *
+     * @param token Completion token, e.g. ``asio::use_awaitable`` in a coroutine
+     */
+    template <typename CompletionToken>
+    auto AsyncNext(CompletionToken&& token) {
+        return asio::async_initiate<CompletionToken, void(asio::error_code, DiscoveryEvent)>(
+            [state = state_, executor = executor_](auto handler) {
+                Wait(state, PostingHandler<DiscoveryEvent>(std::move(handler), executor));
+            },
+            token);
+    }
+
+private:
+    /** Manager creates subscriptions and delivers the events */
+    friend class Manager;
+
+    /** Queued events shared with the manager */
+    struct State;
+
+    /**
+     * @param state Queued events shared with the manager
+     * @param executor Executor of the manager
+     */
+    CHIRP_API DiscoverySubscription(std::shared_ptr<State> state, asio::io_context::executor_type executor);
+
+    /** Complete the handler with the next queued event, or store it until an event arrives */
+    CHIRP_API static void Wait(const std::shared_ptr<State>& state, Handler handler);
+
+private:
+    std::shared_ptr<State> state_;
+    asio::io_context::executor_type executor_;
+};
+
 /** Manager for CHIRP broadcasting and receiving */
 class Manager {
 public:
@@ -85,16 +223,182 @@ public:
      * @param any_address Any address for incoming broadcast messages
      * @param group_name Group name of the group to join
      * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
      */
-    CHIRP_API Manager(asio::ip::address brd_address, asio::ip::address any_address, std::string_view group_name, std::string_view host_name);
+    CHIRP_API Manager(asio::ip::address brd_address, asio::ip::address any_address, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
 
     /**
      * @param brd_ip Broadcast IP for outgoing broadcast messages
      * @param any_ip Any IP for incoming broadcast messages
      * @param group_name Group name of the group to join
      * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(std::string_view brd_ip, std::string_view any_ip, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager using an external IO context
+     *
+     * The manager does not start a background thread, instead all asynchronous operations and discovery callbacks are
+     * executed by the threads running the IO context. This allows to run many managers from a shared thread pool. The IO
+     * context needs to be running when the manager is destroyed, or not be running at all.
+     *
+     * @param io_context IO context used for all sockets of the manager, needs to outlive the manager
+     * @param brd_address Broadcast address for outgoing broadcast messages
+     * @param any_address Any address for incoming broadcast messages
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
      */
-    CHIRP_API Manager(std::string_view brd_ip, std::string_view any_ip, std::string_view group_name, std::string_view host_name);
+    CHIRP_API Manager(asio::io_context& io_context, asio::ip::address brd_address, asio::ip::address any_address, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager using an external IO context and human readable IP addresses
+     *
+     * @param io_context IO context used for all sockets of the manager, needs to outlive the manager
+     * @param brd_ip Broadcast IP for outgoing broadcast messages
+     * @param any_ip Any IP for incoming broadcast messages
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(asio::io_context& io_context, std::string_view brd_ip, std::string_view any_ip, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager using a shared demultiplexer for incoming broadcasts
+     *
+     * Instead of binding its own socket, the manager receives the broadcasts of its group from the demultiplexer, which
+     * decodes every broadcast only once for all registered managers. The IO context of the demultiplexer is used for all
+     * asynchronous operations, see also the constructor using an external IO context. The demultiplexer needs to be
+     * started separately via :cpp:func:`Demultiplexer::Start`.
+     *
+     * @param demultiplexer Demultiplexer for incoming broadcast messages, needs to outlive the manager
+     * @param brd_address Broadcast address for outgoing broadcast messages
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(Demultiplexer& demultiplexer, asio::ip::address brd_address, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager using a shared demultiplexer and human readable IP address
+     *
+     * @param demultiplexer Demultiplexer for incoming broadcast messages, needs to outlive the manager
+     * @param brd_ip Broadcast IP for outgoing broadcast messages
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(Demultiplexer& demultiplexer, std::string_view brd_ip, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager broadcasting on multiple network interfaces
+     *
+     * Outgoing broadcasts are sent on all given interfaces (see :cpp:func:`GetNetworkInterfaces`), while incoming
+     * broadcasts from all interfaces are received by a single socket bound to the any address. This replaces running one
+     * manager per interface to cover multiple subnets.
+     *
+     * @param interfaces Network interfaces for outgoing broadcast messages
+     * @param any_address Any address for incoming broadcast messages
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(std::span<const NetworkInterface> interfaces, asio::ip::address any_address, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager broadcasting on multiple network interfaces using an external IO context
+     *
+     * @param io_context IO context used for all sockets of the manager, needs to outlive the manager
+     * @param interfaces Network interfaces for outgoing broadcast messages
+     * @param any_address Any address for incoming broadcast messages
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(asio::io_context& io_context, std::span<const NetworkInterface> interfaces, asio::ip::address any_address, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager broadcasting on multiple network interfaces using a shared demultiplexer
+     *
+     * @param demultiplexer Demultiplexer for incoming broadcast messages, needs to outlive the manager
+     * @param interfaces Network interfaces for outgoing broadcast messages
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(Demultiplexer& demultiplexer, std::span<const NetworkInterface> interfaces, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager using multicast instead of broadcasts
+     *
+     * Outgoing messages are sent to the multicast address of the group (see :cpp:func:`MulticastAddress`), and the own
+     * demultiplexer joins that multicast group. Thus only hosts with managers of the same group receive the messages.
+     *
+     * @param multicast Marker to select multicast, see :cpp:var:`MULTICAST`
+     * @param any_address Any address for incoming messages, an IPv6 address selects IPv6 multicast
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(MulticastTag multicast, asio::ip::address any_address, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager using multicast and a shared demultiplexer
+     *
+     * Multicast needs to be enabled on the demultiplexer via :cpp:func:`Demultiplexer::EnableMulticast`.
+     *
+     * @param multicast Marker to select multicast, see :cpp:var:`MULTICAST`
+     * @param demultiplexer Demultiplexer for incoming messages, needs to outlive the manager
+     * @param ipv6 Whether to send to the IPv6 multicast address of the group
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager, the receiving socket is ignored if external
+     */
+    CHIRP_API Manager(MulticastTag multicast, Demultiplexer& demultiplexer, bool ipv6, std::string_view group_name, std::string_view host_name,
+                      const SocketOptions& socket_options = {});
+
+    /**
+     * Construct manager sending and receiving via a transport instead of UDP sockets
+     *
+     * The manager creates its own demultiplexer receiving via the transport (see :cpp:class:`Transport`). With a
+     * :cpp:class:`MemoryTransport`, many managers can run in a single process without any sockets.
+     *
+     * @param transport Transport for outgoing and incoming messages, needs to outlive the manager
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     */
+    CHIRP_API Manager(Transport& transport, std::string_view group_name, std::string_view host_name);
+
+    /**
+     * Construct manager using a transport and an external IO context
+     *
+     * @param io_context External IO context, needs to outlive the manager
+     * @param transport Transport for outgoing and incoming messages, needs to outlive the manager
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     */
+    CHIRP_API Manager(asio::io_context& io_context, Transport& transport, std::string_view group_name, std::string_view host_name);
+
+    /**
+     * Construct manager using a shared demultiplexer and sending via a transport
+     *
+     * @param demultiplexer Demultiplexer for incoming messages, needs to outlive the manager
+     * @param transport Transport for outgoing messages, needs to outlive the manager
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     */
+    CHIRP_API Manager(Demultiplexer& demultiplexer, Transport& transport, std::string_view group_name, std::string_view host_name);
 
     CHIRP_API virtual ~Manager();
 
@@ -112,7 +416,13 @@ public:
      */
     constexpr MD5Hash GetHostID() const { return host_id_; }
 
-    /** Start the background thread of the manager */
+    /**
+     * Start receiving incoming CHIRP broadcasts
+     *
+     * This registers the manager in its demultiplexer. If the manager owns its IO context, this also starts the
+     * background thread of the manager. Otherwise the incoming broadcasts are handled by the threads running the external
+     * IO context. From then on, outgoing broadcasts are sent asynchronously from the IO context.
+     */
     CHIRP_API void Start();
 
     /**
@@ -155,11 +465,106 @@ public:
      */
     CHIRP_API std::set<RegisteredService> GetRegisteredServices();
 
+    /**
+     * Configure the scheduling of OFFER replies to incoming REQUESTs
+     *
+     * By default, the OFFERs of all registered services with the requested service identifier are broadcast immediately
+     * for every REQUEST. With many hosts and requesters, e.g. at startup, this results in a storm of broadcasts. Since
+     * broadcasts are seen by every requester, it is sufficient to reply once to multiple REQUESTs received in short
+     * succession:
+     *
+     * - REQUESTs for the same service identifier arriving while a reply is scheduled are coalesced into that reply.
+     * - REQUESTs arriving within the window after the OFFERs were broadcast are not replied to, regardless of whether the
+     *   OFFERs were broadcast in reply, as announcement (see :cpp:func:`SetAnnounceInterval`) or when registering the only
+     *   service with the service identifier.
+     * - Replies are delayed by a uniformly distributed random jitter, spreading the replies of many hosts.
+     *
+     * @param window Duration after a reply in which further REQUESTs for the same service identifier are not replied to
+     * @param jitter Maximum random delay of a reply
+     */
+    CHIRP_API void SetReplyScheduling(std::chrono::steady_clock::duration window, std::chrono::steady_clock::duration jitter);
+
+    /**
+     * Set the interval for periodic announcements of the registered services
+     *
+     * By default, OFFERs are only broadcast when a service is registered and in reply to REQUESTs. With an announcement
+     * interval, the OFFERs of all registered services are additionally broadcast periodically, such that other managers
+     * can keep track of the liveness of the services (see :cpp:func:`SetDiscoveryTTL`). Needs to be called before
+     * :cpp:func:`Start`.
+     *
+     * @param interval Interval between announcements, zero to disable announcements
+     */
+    CHIRP_API void SetAnnounceInterval(std::chrono::steady_clock::duration interval);
+
+    /**
+     * Set the time to live of discovered services
+     *
+     * By default, discovered services are only removed on a DEPART or via :cpp:func:`ForgetDiscoveredServices`, such
+     * that services of crashed hosts are never removed. With a time to live, each OFFER refreshes the service and
+     * services which have not been seen for the time to live are removed, dispatching the callbacks as for a DEPART.
+     * The time to live should be a few announcement intervals of the other hosts. Needs to be called before
+     * :cpp:func:`Start`.
+     *
+     * Expiry is driven by a :cpp:class:`TimerWheel` with a resolution of a sixteenth of the time to live, such that
+     * services expire up to that much after their time to live.
+     *
+     * @param ttl Time to live of discovered services, zero to disable expiry
+     */
+    CHIRP_API void SetDiscoveryTTL(std::chrono::steady_clock::duration ttl);
+
+    /**
+     * Enable the persisted discovery cache for fast warm restarts
+     *
+     * Without a cache, a restarted manager knows no services until it sent REQUESTs and received the OFFERs of all
+     * hosts. With a cache, the discovered services of the group are stored in a :cpp:class:`DiscoveryCache` when the
+     * manager is destroyed or via :cpp:func:`StoreDiscoveryCache`. On :cpp:func:`Start`, the stored services are loaded
+     * as tentative services, which are discovered immediately, dispatching the callbacks as for an OFFER. A single
+     * REQUEST is broadcast per service identifier of the tentative services, and every OFFER received in reply confirms
+     * the service. Tentative services which are not confirmed within the confirmation timeout are removed, dispatching
+     * the callbacks as for a DEPART. Needs to be called before :cpp:func:`Start`.
+     *
+     * @param directory Directory of the cache, snapshots are stored per group
+     * @param confirm_timeout Time after the start until which tentative services need to be confirmed
+     */
+    CHIRP_API void SetDiscoveryCache(std::filesystem::path directory,
+                                     std::chrono::steady_clock::duration confirm_timeout = std::chrono::seconds(3));
+
+    /**
+     * Store the discovered services in the discovery cache
+     *
+     * Tentative services which are not confirmed yet are not stored. This is done automatically when the manager is
+     * destroyed, but can be called e.g. periodically such that the cache survives a crash.
+     *
+     * @retval true If the services were stored
+     * @retval false If no discovery cache is enabled or the services could not be stored
+     */
+    CHIRP_API bool StoreDiscoveryCache();
+
+    /**
+     * Set the number of threads executing the discovery callbacks
+     *
+     * By default, a manager with an own IO context executes the callbacks on an own worker pool with two threads (see
+     * :cpp:class:`CallbackDispatcher`), while a manager with an external IO context executes them on that IO context.
+     * With a non-zero number of threads, the callbacks are executed on an own worker pool with that many threads, also
+     * when using an external IO context. The dispatcher can only be replaced before the manager is started, since
+     * receiving and the timers dispatch callbacks without locking afterwards.
+     *
+     * @param threads Number of worker threads, zero for the default
+     * @retval true If the number of threads was set
+     * @retval false If the manager was already started
+     */
+    CHIRP_API bool SetCallbackThreads(std::size_t threads);
+
     /**
      * Register a user callback for newly discovered or departing servies
      *
      * Note that a callback function can be registered multiple times for different servies.
      *
+     * Callbacks are executed by a :cpp:class:`CallbackDispatcher`, in order per discovered service. Callbacks must not
+     * block: a blocking callback delays all callbacks sharing its lane and, when the callbacks are executed on an
+     * external IO context (see :cpp:func:`SetCallbackThreads`), receiving and expiry of services as well. Long-running
+     * work should be handed off to another thread.
+     *
      * @param callback Function pointer to a callback
      * @param service_id Service identifier of the service for which callbacks should be received
      * @param user_data Arbitrary user data passed to the callback function (see :cpp:type:`DiscoverCallback`)
@@ -178,19 +583,90 @@ public:
      */
     CHIRP_API bool UnregisterDiscoverCallback(DiscoverCallback* callback, ServiceIdentifier service_id);
 
+    /**
+     * Register a batched user callback for newly discovered or departing services
+     *
+     * Instead of one call per service, the callback receives all changes of the given service identifier gathered over
+     * one receive batch or coalescing window. This allows to react to a burst of OFFERs, e.g. after a REQUEST to a large
+     * group, only once. Note that a callback function can be registered multiple times for different services.
+     *
+     * @param callback Function pointer to a batch callback
+     * @param service_id Service identifier of the service for which callbacks should be received
+     * @param user_data Pointer to user data passed to the callback function (see :cpp:type:`DiscoverBatchCallback`)
+     * @retval true If the callback/service combination was registered
+     * @retval false If the callback/service combination was already registered
+     */
+    CHIRP_API bool RegisterDiscoverBatchCallback(DiscoverBatchCallback* callback, ServiceIdentifier service_id, void* user_data);
+
+    /**
+     * Unregister a previously registered batched callback for newly discovered or departing services
+     *
+     * @param callback Function pointer to the callback of registered callback entry
+     * @param service_id Service identifier of registered callback entry
+     * @retval true If the callback entry was unregistered
+     * @retval false If the callback entry was never registered
+     */
+    CHIRP_API bool UnregisterDiscoverBatchCallback(DiscoverBatchCallback* callback, ServiceIdentifier service_id);
+
+    /**
+     * Set the coalescing window for batched discovery callbacks
+     *
+     * By default (zero window), the events are delivered after every receive batch. With a non-zero window, the events
+     * are collected from the first event on for the duration of the window before being delivered, such that a burst
+     * spread over multiple receive batches results in a single callback.
+     *
+     * @param window Duration of the coalescing window
+     */
+    CHIRP_API void SetDiscoverBatchWindow(std::chrono::steady_clock::duration window);
+
     /**
      * Unregisteres all discovery callbacks registered in the manager
      *
-     * Equivalent to calling :cpp:func:`UnregisterDiscoverCallback` for every discovery callback.
+     * Equivalent to calling :cpp:func:`UnregisterDiscoverCallback` for every discovery callback and
+     * :cpp:func:`UnregisterDiscoverBatchCallback` for every batched discovery callback.
      */
     CHIRP_API void UnregisterDiscoverCallbacks();
 
     /** Forgets all previously discovered services */
     CHIRP_API void ForgetDiscoveredServices();
 
+    /**
+     * Returns the number of incoming broadcasts dropped by the kernel
+     *
+     * See :cpp:func:`Demultiplexer::GetDroppedMessages`, which is shared by all managers using the same demultiplexer.
+     *
+     * @returns Number of dropped broadcasts
+     */
+    std::uint32_t GetDroppedMessages() const { return demultiplexer_.GetDroppedMessages(); }
+
+    /**
+     * Returns the metrics of the manager
+     *
+     * This combines the metrics of the manager, its sender and its own demultiplexer (see :cpp:class:`Metrics`). When
+     * using a shared demultiplexer, its metrics are not included since they cover all managers using it, see
+     * :cpp:func:`Demultiplexer::GetMetricsSnapshot`. The snapshot can be exported via
+     * :cpp:func:`MetricsSnapshot::ToPrometheus`.
+     *
+     * @returns Combined snapshot of the metrics
+     */
+    CHIRP_API MetricsSnapshot GetMetricsSnapshot() const;
+
+    /**
+     * Returns a snapshot of all discovered services
+     *
+     * The snapshot is immutable and ordered by service identifier. The manager publishes a new snapshot after each receive batch in which the
+     * discovered services changed, an existing snapshot is never modified. Reading a snapshot locks no mutex of the
+     * manager and does not allocate, such that it can be called at high frequency, e.g. to pick endpoints.
+     *
+     * @returns Shared pointer to vector with all discovered services
+     */
+    CHIRP_API std::shared_ptr<const std::vector<DiscoveredService>> GetDiscoveredServicesSnapshot() const;
+
     /**
      * Returns list of all discovered services
      *
+     * This copies the current snapshot, see :cpp:func:`GetDiscoveredServicesSnapshot`.
+     *
      * @returns Vector with all discovered services
      */
     CHIRP_API std::vector<DiscoveredService> GetDiscoveredServices();
@@ -203,6 +679,45 @@ public:
      */
     CHIRP_API std::vector<DiscoveredService> GetDiscoveredServices(ServiceIdentifier service_id);
 
+    /** Return the executor of the IO context used by the manager */
+    asio::io_context::executor_type GetExecutor() const { return io_context_.get_executor(); }
+
+    /**
+     * Asynchronously wait until a service with a given service identifier is discovered
+     *
+     * Completes immediately if such a service is already discovered, otherwise as soon as an OFFER for a matching service
+     * arrives. This uses the completion token mechanism of asio, such that e.g. within a coroutine
+     * ``co_await manager.AsyncDiscover(DATA, 1s, asio::use_awaitable)`` suspends until the service is discovered,
+     * without polling and without an additional thread. The handler is executed by its associated executor, which
+     * defaults to :cpp:func:`GetExecutor`. Note that no REQUEST is sent, see :cpp:func:`SendRequest`.
+     *
+     * The completion signature is ``void(asio::error_code, DiscoveredService)``. The error code is
+     * ``asio::error::timed_out`` if no service was discovered before the timeout, and ``asio::error::operation_aborted``
+     * if the manager is destroyed before.
+     *
+     * @param service_id Service identifier of the service to wait for
+     * @param timeout Maximum duration to wait
+     * @param token Completion token, e.g. ``asio::use_awaitable`` in a coroutine
+     */
+    template <typename CompletionToken>
+    auto AsyncDiscover(ServiceIdentifier service_id, std::chrono::steady_clock::duration timeout, CompletionToken&& token) {
+        return asio::async_initiate<CompletionToken, void(asio::error_code, DiscoveredService)>(
+            [this, service_id, timeout](auto handler) {
+                AddDiscoverWaiter(service_id, timeout, PostingHandler<DiscoveredService>(std::move(handler), GetExecutor()));
+            },
+            token);
+    }
+
+    /**
+     * Subscribe to the changes of discovered services with a given service identifier
+     *
+     * See :cpp:class:`DiscoverySubscription`.
+     *
+     * @param service_id Service identifier of the services
+     * @returns Subscription queuing the discovery events
+     */
+    CHIRP_API DiscoverySubscription SubscribeDiscovery(ServiceIdentifier service_id);
+
     /**
      * Send a discovery request for a specific service identifier
      *
@@ -225,41 +740,319 @@ private:
     void SendMessage(MessageType type, RegisteredService service);
 
     /**
-     * Run loop listening and responding to incoming CHIRP broadcasts
+     * Send multiple assembled CHIRP broadcasts
      *
-     * The run loop responds to incoming CHIRP broadcasts with REQUEST type by sending CHIRP broadcasts with OFFER type for
-     * all registered servies. It also tracks incoming CHIRP broadcasts with OFFER and DEPART type to form the list of
+     * After the manager is started, the messages are queued for asynchronous sending (see
+     * :cpp:func:`BroadcastSend::AsyncSendBroadcast`), such that the calling thread never blocks on the socket. Otherwise
+     * the messages are sent synchronously in a single batch. When using a transport, the messages are passed to the
+     * transport in a single batch.
+     *
+     * @param asm_msgs Assembled CHIRP messages
+     */
+    void SendMessages(std::span<const AssembledMessage> asm_msgs);
+
+    /**
+     * Handle an incoming CHIRP message of the manager's group
+     *
+     * This function responds to incoming CHIRP broadcasts with REQUEST type by sending CHIRP broadcasts with OFFER type
+     * for all registered servies. It also tracks incoming CHIRP broadcasts with OFFER and DEPART type to form the list of
      * discovered services and calls the corresponding discovery callbacks.
      *
+     * This function is called by the :cpp:class:`Demultiplexer` of the manager.
+     *
+     * @param chirp_msg Decoded CHIRP message with the group ID of the manager, not sent by the manager itself
+     * @param address Address from which the message was received
+     */
+    void HandleMessage(const Message& chirp_msg, const asio::ip::address& address);
+
+    /**
+     * Dispatch discovery callbacks for a change of a discovered service
+     *
+     * Callbacks registered via :cpp:func:`RegisterDiscoverCallback` are dispatched immediately, while the event is queued
+     * for the callbacks registered via :cpp:func:`RegisterDiscoverBatchCallback`.
+     *
+     * @param service Discovered or departing service
+     * @param depart True if the service is departing
+     */
+    void NotifyDiscovery(const DiscoveredService& service, bool depart);
+
+    /**
+     * Publish a new snapshot of the discovered services
+     *
+     * Requires :cpp:member:`discovered_services_mutex_` to be locked by the caller.
+     */
+    void PublishDiscoveredServices();
+
+    /**
+     * Deliver the queued discovery events to the batched discovery callbacks
+     *
+     * This function is called by the :cpp:class:`Demultiplexer` after each receive batch. It publishes a new snapshot of
+     * the discovered services if they changed and dispatches the discovery callbacks for all changes of the batch. With a
+     * coalescing window, the delivery to batched discovery callbacks is delayed until the window expired. Flushes from
+     * the receive batches, the expiry timers and :cpp:func:`Start` are serialized by :cpp:member:`flush_mutex_`, such that
+     * the events are dispatched in the order they were recorded.
+     */
+    void FlushDiscoveryEvents();
+
+    /**
+     * Run loop for incoming CHIRP broadcasts
+     *
+     * The loop runs the IO context owned by the manager with a continuous asynchronous receive (see
+     * :cpp:func:`BroadcastRecv::StartAsyncRecv`), which executes :cpp:func:`HandleMessage` as soon as a broadcast
+     * arrives. No polling is involved, and a stop request is posted to the IO context immediately.
+     *
      * @param stop_token Token to stop loop via :cpp:class:`std::jthread`
      */
     void Run(std::stop_token stop_token);
 
 private:
-    BroadcastRecv receiver_;
-    BroadcastSend sender_;
+    /**
+     * @param own_io_context IO context owned by the manager, or nullptr if external
+     * @param external_io_context External IO context, or nullptr to use own IO context
+     * @param own_demultiplexer_address Any address for demultiplexer owned by the manager, ignored if external
+     * @param external_demultiplexer External demultiplexer, or nullptr to use own demultiplexer
+     * @param transport Transport replacing the sockets of the manager, or nullptr to use UDP sockets
+     * @param interfaces Network interfaces for outgoing broadcast messages, ignored if a transport is used
+     * @param group_name Group name of the group to join
+     * @param host_name Host name for outgoing messages
+     * @param socket_options Options for the sockets of the manager
+     */
+    Manager(std::unique_ptr<asio::io_context> own_io_context, asio::io_context* external_io_context,
+            asio::ip::address own_demultiplexer_address, Demultiplexer* external_demultiplexer, Transport* transport,
+            std::vector<NetworkInterface> interfaces, std::string_view group_name, std::string_view host_name,
+            const SocketOptions& socket_options);
+
+    /** Demultiplexer calls :cpp:func:`HandleMessage` and :cpp:func:`FlushDiscoveryEvents` */
+    friend class Demultiplexer;
+
+    /** Queued discovery events shared with the handler of the coalescing timer */
+    struct PendingDiscoveryEvents;
+
+    /** State of the OFFER reply scheduling shared with the handlers of the reply timers */
+    struct ReplySchedule;
+
+    /** Liveness configuration shared with the handlers of the announcement and expiry timers */
+    struct Liveness;
+
+    /** Pending :cpp:func:`AsyncDiscover` operation shared with the handler of its timeout timer */
+    struct DiscoverWaiter;
+
+    /**
+     * Register a pending :cpp:func:`AsyncDiscover` operation
+     *
+     * @param service_id Service identifier of the service to wait for
+     * @param timeout Maximum duration to wait
+     * @param handler Type-erased completion handler
+     */
+    CHIRP_API void AddDiscoverWaiter(ServiceIdentifier service_id, std::chrono::steady_clock::duration timeout,
+                                     std::function<void(asio::error_code, DiscoveredService)> handler);
+
+    /** Scheduled expiry check of a discovered service */
+    struct ScheduledExpiry {
+        /** Discovered service to check */
+        DiscoveredService service;
+        /** Time for which the check was scheduled, outdated if it differs from the timestamp in the table */
+        std::chrono::steady_clock::time_point expiry;
+    };
+
+    /**
+     * Reply to a REQUEST according to the reply scheduling
+     *
+     * @param service_id Requested service identifier
+     */
+    void ScheduleReply(ServiceIdentifier service_id);
+
+    /**
+     * Broadcast the pre-assembled OFFERs of all registered services with a service identifier
+     *
+     * @param service_id Service identifier of the services
+     */
+    void SendOffers(ServiceIdentifier service_id);
+
+    /**
+     * Record that the OFFERs of all registered services with a service identifier were just broadcast
+     *
+     * @param service_id Service identifier of the services
+     */
+    void RecordOffersSent(ServiceIdentifier service_id);
+
+    /**
+     * Arm the timer for the next announcement of the registered services
+     *
+     * Requires the mutex of :cpp:member:`liveness_` to be locked by the caller.
+     */
+    void ScheduleAnnouncement();
+
+    /**
+     * Arm the timer for the next tick of :cpp:member:`expiry_wheel_`
+     *
+     * The timer is only armed if it is not armed yet and expiry checks are scheduled. Requires the mutex of
+     * :cpp:member:`liveness_` to be locked by the caller, but not :cpp:member:`discovered_services_mutex_`.
+     */
+    void ScheduleExpiryCheck();
+
+    /**
+     * Advance :cpp:member:`expiry_wheel_` and remove discovered services which exceeded their time to live
+     *
+     * Services which were refreshed since their check was scheduled are rescheduled for their new expiry.
+     */
+    void ExpireDiscoveredServices();
+
+    /**
+     * Load the discovery cache as tentative services and broadcast the REQUESTs to confirm them
+     *
+     * Requires the mutex of :cpp:member:`liveness_` to be locked by the caller.
+     */
+    void LoadDiscoveryCache();
+
+    /**
+     * Replace a confirmed tentative service if its address changed
+     *
+     * Requires :cpp:member:`discovered_services_mutex_` to be locked by the caller.
+     *
+     * @param service Service of the confirming OFFER
+     */
+    void ConfirmTentativeService(const DiscoveredService& service);
+
+    /** Remove tentative services which were not confirmed within the confirmation timeout */
+    void ExpireTentativeServices();
+
+    /**
+     * Wrap a discovery callback task to record its queue delay
+     *
+     * @param task Task executing the callback
+     * @return Task recording the delay between this call and its execution, or the task itself if metrics are disabled
+     */
+    CallbackDispatcher::Task MeasuredTask(CallbackDispatcher::Task task);
+
+    /**
+     * Dispatch the queued discovery events to the batched discovery callbacks
+     *
+     * @param pending Queued discovery events, the mutex needs to be locked by the caller
+     */
+    void DispatchDiscoveryEvents(PendingDiscoveryEvents& pending);
+
+private:
+    std::unique_ptr<asio::io_context> own_io_context_;
+    asio::io_context& io_context_;
+
+    std::unique_ptr<Demultiplexer> own_demultiplexer_;
+    Demultiplexer& demultiplexer_;
+
+    /** Sender for outgoing broadcasts, nullptr if a transport is used */
+    std::unique_ptr<BroadcastSend> sender_;
+
+    /** Transport for outgoing messages, nullptr if the own sender is used */
+    Transport* transport_;
 
     MD5Hash group_id_;
     MD5Hash host_id_;
 
+    /** Builder for outgoing messages with pre-hashed group and host ID */
+    MessageBuilder message_builder_;
+
     /** Set of registered services */
     std::set<RegisteredService> registered_services_;
 
-    /** Mutex for thread-safe access to :cpp:member:`registered_services_` */
+    /** Pre-assembled OFFERs of the registered services, indexed by service identifier */
+    std::array<std::vector<AssembledMessage>, SERVICE_IDENTIFIER_COUNT> registered_offers_;
+
+    /** Mutex for thread-safe access to :cpp:member:`registered_services_` and :cpp:member:`registered_offers_` */
     std::mutex registered_services_mutex_;
 
-    /** Set of discovered services */
-    std::set<DiscoveredService> discovered_services_;
+    /** Table of discovered services */
+    DiscoveredServiceTable discovered_services_;
+
+    /** Whether :cpp:member:`discovered_services_` changed since the last published snapshot */
+    bool discovered_services_changed_ {false};
 
-    /** Mutex for thread-safe access to :cpp:member:`discovered_services_` */
+    /** Changes of :cpp:member:`discovered_services_` in the current receive batch */
+    std::vector<DiscoveryEvent> discovery_events_;
+
+    /** Mutex for thread-safe access to :cpp:member:`discovered_services_` and the changes */
     std::mutex discovered_services_mutex_;
 
-    /** Set of discovery callbacks */
-    std::set<DiscoverCallbackEntry> discover_callbacks_;
+    /** Mutex serializing :cpp:func:`FlushDiscoveryEvents`, locked before :cpp:member:`discovered_services_mutex_` */
+    std::mutex flush_mutex_;
+
+    /** Immutable snapshot of :cpp:member:`discovered_services_` for lock-free readers */
+    std::atomic<std::shared_ptr<const std::vector<DiscoveredService>>> discovered_services_snapshot_;
+
+    /** Time to live of discovered services, zero if disabled, guarded by :cpp:member:`discovered_services_mutex_` */
+    std::chrono::steady_clock::duration discovery_ttl_ {std::chrono::steady_clock::duration::zero()};
+
+    /** Expiry checks of discovered services, guarded by :cpp:member:`discovered_services_mutex_` */
+    TimerWheel<ScheduledExpiry> expiry_wheel_;
+
+    /**
+     * Services loaded from the discovery cache which were not confirmed by an OFFER yet, guarded by
+     * :cpp:member:`discovered_services_mutex_`
+     */
+    DiscoveredServiceTable tentative_services_;
+
+    /** Persisted snapshot of the discovered services, empty if disabled */
+    std::optional<DiscoveryCache> discovery_cache_;
+
+    /**
+     * Discovery callbacks, indexed by service identifier
+     *
+     * Each list is immutable and replaced on modification, such that dispatching reads the list of a single service
+     * identifier without locking :cpp:member:`discover_callbacks_mutex_`.
+     */
+    std::array<std::atomic<std::shared_ptr<const std::vector<DiscoverCallbackEntry>>>, SERVICE_IDENTIFIER_COUNT> discover_callbacks_;
+
+    /** Batched discovery callbacks, indexed by service identifier, replaced on modification as for discovery callbacks */
+    std::array<std::atomic<std::shared_ptr<const std::vector<DiscoverBatchCallbackEntry>>>, SERVICE_IDENTIFIER_COUNT>
+        discover_batch_callbacks_;
 
-    /** Mutex for thread-safe access to :cpp:member:`discover_callbacks_` */
+    /** Mutex serializing modifications of :cpp:member:`discover_callbacks_` and :cpp:member:`discover_batch_callbacks_` */
     std::mutex discover_callbacks_mutex_;
 
+    /** Pending :cpp:func:`AsyncDiscover` operations, indexed by service identifier */
+    std::array<std::vector<std::shared_ptr<DiscoverWaiter>>, SERVICE_IDENTIFIER_COUNT> discover_waiters_;
+
+    /** Discovery subscriptions, indexed by service identifier */
+    std::array<std::vector<std::shared_ptr<DiscoverySubscription::State>>, SERVICE_IDENTIFIER_COUNT> discovery_subscriptions_;
+
+    /** Mutex for thread-safe access to :cpp:member:`discover_waiters_` and :cpp:member:`discovery_subscriptions_` */
+    std::mutex discover_waiters_mutex_;
+
+    /** Whether waiters or subscriptions exist per service identifier, allows dispatching without locking if not */
+    std::array<std::atomic_bool, SERVICE_IDENTIFIER_COUNT> discover_waiters_active_ {};
+
+    /** Timer for the coalescing window of batched discovery callbacks */
+    asio::steady_timer discover_batch_timer_;
+
+    /** Discovery events queued for batched discovery callbacks */
+    std::shared_ptr<PendingDiscoveryEvents> pending_discovery_events_;
+
+    /** Timers for scheduled OFFER replies, indexed by service identifier */
+    std::vector<asio::steady_timer> reply_timers_;
+
+    /** State of the OFFER reply scheduling */
+    std::shared_ptr<ReplySchedule> reply_schedule_;
+
+    /** Timer for periodic announcements of the registered services */
+    asio::steady_timer announce_timer_;
+
+    /** Timer for the ticks of :cpp:member:`expiry_wheel_` */
+    asio::steady_timer expiry_timer_;
+
+    /** Timer for the confirmation timeout of the tentative services */
+    asio::steady_timer tentative_timer_;
+
+    /** Liveness configuration */
+    std::shared_ptr<Liveness> liveness_;
+
+    /** Metrics of the manager, shared with dispatched callbacks which might outlive the manager */
+    std::shared_ptr<Metrics> metrics_;
+
+    /** Dispatcher for discovery callbacks, uses the external IO context if given or an own worker pool otherwise */
+    std::unique_ptr<CallbackDispatcher> callback_dispatcher_;
+
+    /** Whether the manager was started, after which the callback dispatcher is no longer replaced */
+    std::atomic_bool started_ {false};
+
     std::jthread run_thread_;
 };
 
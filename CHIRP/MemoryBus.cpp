@@ -0,0 +1,174 @@
+#include "MemoryBus.hpp"
+
+#include <algorithm>
+#include <array>
+#include <utility>
+
+#include "CHIRP/BoundedQueue.hpp"
+#include "CHIRP/BroadcastRecv.hpp"
+
+using namespace cnstln::CHIRP;
+
+struct MemoryBus::Endpoint {
+    Endpoint(std::size_t queue_capacity, std::optional<asio::any_io_executor> executor)
+      : queue(queue_capacity), executor(std::move(executor)) {}
+    /** Execute the callback for all queued messages in batches, returns the number of delivered messages */
+    std::size_t Deliver() {
+        const std::lock_guard callback_lock {callback_mutex};
+        // Execute a copy, such that the callback can stop the transport which resets the callback
+        const auto callback_l = callback;
+        std::array<BatchedBroadcastMessage, 64> batch {};
+        std::size_t delivered = 0;
+        while (receiving.load(std::memory_order_acquire)) {
+            std::size_t count = 0;
+            while (count < batch.size() && queue.TryPop(batch[count])) {
+                ++count;
+            }
+            if (count == 0) {
+                break;
+            }
+            if (callback_l) {
+                callback_l({batch.data(), count});
+            }
+            metrics.Increment(MetricCounter::DATAGRAMS_RECEIVED, count);
+            delivered += count;
+        }
+        return delivered;
+    }
+    /** Queue of incoming messages */
+    BoundedQueue<BatchedBroadcastMessage> queue;
+    /** Executor for deliveries, deliveries via :cpp:func:`MemoryBus::Poll` if empty */
+    std::optional<asio::any_io_executor> executor;
+    /** Whether a delivery is posted to the executor */
+    std::atomic_flag delivery_pending;
+    /** Whether messages are queued */
+    std::atomic_bool receiving {false};
+    /**
+     * Mutex held while delivering, such that the callback is not executed after stopping, recursive to allow stopping
+     * from the callback
+     */
+    std::recursive_mutex callback_mutex;
+    /** Callback for incoming messages */
+    AsyncRecvBatchCallback callback;
+    /** Number of messages dropped since the queue was full */
+    std::atomic_uint32_t dropped {0};
+    /** Received and sent messages */
+    Metrics metrics;
+};
+
+MemoryBus::MemoryBus() : next_host_(0) {
+    endpoints_.store(std::make_shared<const std::vector<std::shared_ptr<Endpoint>>>());
+}
+
+std::size_t MemoryBus::Poll() {
+    std::size_t delivered = 0;
+    while (true) {
+        std::size_t pass = 0;
+        for (const auto& endpoint : *endpoints_.load(std::memory_order_acquire)) {
+            if (!endpoint->executor.has_value()) {
+                pass += endpoint->Deliver();
+            }
+        }
+        if (pass == 0) {
+            break;
+        }
+        delivered += pass;
+    }
+    return delivered;
+}
+
+std::size_t MemoryBus::Size() const {
+    return endpoints_.load(std::memory_order_acquire)->size();
+}
+
+asio::ip::address_v4 MemoryBus::Connect(std::shared_ptr<Endpoint> endpoint) {
+    const std::lock_guard endpoints_lock {endpoints_mutex_};
+    auto endpoints = *endpoints_.load(std::memory_order_relaxed);
+    endpoints.push_back(std::move(endpoint));
+    endpoints_.store(std::make_shared<const std::vector<std::shared_ptr<Endpoint>>>(std::move(endpoints)),
+                     std::memory_order_release);
+    // Addresses in 127.0.0.0/8, starting from 127.0.0.1
+    return asio::ip::address_v4(0x7F000000U | ((++next_host_) & 0x00FFFFFFU));
+}
+
+void MemoryBus::Disconnect(const std::shared_ptr<Endpoint>& endpoint) {
+    const std::lock_guard endpoints_lock {endpoints_mutex_};
+    auto endpoints = *endpoints_.load(std::memory_order_relaxed);
+    std::erase(endpoints, endpoint);
+    endpoints_.store(std::make_shared<const std::vector<std::shared_ptr<Endpoint>>>(std::move(endpoints)),
+                     std::memory_order_release);
+}
+
+void MemoryBus::Send(const asio::ip::address_v4& source, std::span<const AssembledMessage> messages) {
+    // Convert once for all receivers
+    std::vector<BatchedBroadcastMessage> batched {};
+    batched.reserve(messages.size());
+    for (const auto& message : messages) {
+        auto& batched_message = batched.emplace_back();
+        std::ranges::copy(message, batched_message.content.begin());
+        batched_message.length = message.size();
+        batched_message.address = source;
+    }
+    const auto endpoints = endpoints_.load(std::memory_order_acquire);
+    for (const auto& endpoint : *endpoints) {
+        if (!endpoint->receiving.load(std::memory_order_acquire)) {
+            continue;
+        }
+        for (const auto& batched_message : batched) {
+            if (!endpoint->queue.TryPush(batched_message)) {
+                endpoint->dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        // Post a single delivery for all messages queued until it runs
+        if (endpoint->executor.has_value() && !endpoint->delivery_pending.test_and_set(std::memory_order_acq_rel)) {
+            asio::post(endpoint->executor.value(), [endpoint]() {
+                endpoint->delivery_pending.clear(std::memory_order_release);
+                endpoint->Deliver();
+            });
+        }
+    }
+}
+
+MemoryTransport::MemoryTransport(MemoryBus& bus, std::size_t queue_capacity)
+  : bus_(bus), endpoint_(std::make_shared<MemoryBus::Endpoint>(queue_capacity, std::nullopt)),
+    address_(bus_.Connect(endpoint_)) {}
+
+MemoryTransport::MemoryTransport(MemoryBus& bus, asio::any_io_executor executor, std::size_t queue_capacity)
+  : bus_(bus), endpoint_(std::make_shared<MemoryBus::Endpoint>(queue_capacity, std::move(executor))),
+    address_(bus_.Connect(endpoint_)) {}
+
+MemoryTransport::~MemoryTransport() {
+    StopReceive();
+    // A posted delivery keeps the endpoint alive but does not execute a callback anymore
+    bus_.Disconnect(endpoint_);
+}
+
+void MemoryTransport::Send(std::span<const AssembledMessage> messages) {
+    endpoint_->metrics.Increment(MetricCounter::MESSAGES_SENT, messages.size());
+    bus_.Send(address_, messages);
+}
+
+void MemoryTransport::StartReceive(AsyncRecvBatchCallback callback) {
+    const std::lock_guard callback_lock {endpoint_->callback_mutex};
+    endpoint_->callback = std::move(callback);
+    endpoint_->receiving.store(true, std::memory_order_release);
+}
+
+void MemoryTransport::StopReceive() {
+    // Waits until a running delivery is finished, unless called from the callback
+    const std::lock_guard callback_lock {endpoint_->callback_mutex};
+    endpoint_->receiving.store(false, std::memory_order_release);
+    endpoint_->callback = nullptr;
+    // Discard queued messages like a closed socket
+    BatchedBroadcastMessage message {};
+    while (endpoint_->queue.TryPop(message)) {
+    }
+}
+
+std::uint32_t MemoryTransport::GetDroppedMessages() const {
+    return endpoint_->dropped.load(std::memory_order_relaxed);
+}
+
+MetricsSnapshot MemoryTransport::GetMetricsSnapshot() const {
+    return endpoint_->metrics.Snapshot();
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "CHIRP/config.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/Transport.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+class MemoryTransport;
+
+/**
+ * In-process bus connecting :cpp:class:`MemoryTransport` instances
+ *
+ * Every message sent via a transport of the bus is copied into the lock-free receive queue (see
+ * :cpp:class:`BoundedQueue`) of every transport connected to the bus which is receiving, including the sending transport
+ * itself. Messages are delivered either by the executor of the receiving transport or by calling :cpp:func:`Poll`, which
+ * allows to run thousands of managers in a single process without any system calls and with a deterministic order of
+ * delivery.
+ *
+ * Each transport is assigned a unique loopback address (starting from 127.0.0.1), which is reported as address of the
+ * messages it sends.
+ */
+class MemoryBus {
+public:
+    CHIRP_API MemoryBus();
+
+    // No copy or move since transports reference the bus
+    MemoryBus(const MemoryBus& other) = delete;
+    MemoryBus& operator=(const MemoryBus& other) = delete;
+    MemoryBus(MemoryBus&& other) = delete;
+    MemoryBus& operator=(MemoryBus&& other) = delete;
+
+    /**
+     * Deliver all queued messages of transports without executor
+     *
+     * Messages sent while delivering are delivered as well, such that the bus is idle when this function returns. The
+     * callbacks of the transports are executed in the calling thread.
+     *
+     * @return Number of delivered messages
+     */
+    CHIRP_API std::size_t Poll();
+
+    /** Return the number of connected transports */
+    CHIRP_API std::size_t Size() const;
+
+private:
+    friend class MemoryTransport;
+
+    /** Transport state shared with the bus and with posted deliveries */
+    struct Endpoint;
+
+    /** Connect an endpoint to the bus and return its address */
+    asio::ip::address_v4 Connect(std::shared_ptr<Endpoint> endpoint);
+
+    /** Disconnect an endpoint from the bus */
+    void Disconnect(const std::shared_ptr<Endpoint>& endpoint);
+
+    /** Copy messages into the receive queues of all receiving endpoints */
+    void Send(const asio::ip::address_v4& source, std::span<const AssembledMessage> messages);
+
+private:
+    /** Connected endpoints, replaced on connect and disconnect such that sending does not lock */
+    std::atomic<std::shared_ptr<const std::vector<std::shared_ptr<Endpoint>>>> endpoints_;
+
+    /** Mutex serializing connect and disconnect */
+    std::mutex endpoints_mutex_;
+
+    /** Host part of the address of the next connected endpoint */
+    std::uint32_t next_host_;
+};
+
+/**
+ * Transport connected to a :cpp:class:`MemoryBus`
+ *
+ * Incoming messages are queued in a bounded lock-free queue. If the queue is full, e.g. because the messages are not
+ * delivered fast enough, further messages are dropped like by a full socket buffer (see :cpp:func:`GetDroppedMessages`).
+ * Messages sent while the transport is not receiving are not queued.
+ */
+class CHIRP_API MemoryTransport : public Transport {
+public:
+    /**
+     * Construct transport delivering messages when the bus is polled
+     *
+     * @param bus Bus to connect to, needs to outlive the transport
+     * @param queue_capacity Number of incoming messages which can be queued
+     */
+    MemoryTransport(MemoryBus& bus, std::size_t queue_capacity = 4096);
+
+    /**
+     * Construct transport delivering messages via an executor
+     *
+     * A delivery of all queued messages is posted to the executor when a message is queued and no delivery is pending.
+     *
+     * @param bus Bus to connect to, needs to outlive the transport
+     * @param executor Executor executing the callback, needs to outlive the transport or to be stopped before
+     * @param queue_capacity Number of incoming messages which can be queued
+     */
+    MemoryTransport(MemoryBus& bus, asio::any_io_executor executor, std::size_t queue_capacity = 4096);
+
+    ~MemoryTransport() override;
+
+    // No copy or move since the bus references the transport state
+    MemoryTransport(const MemoryTransport& other) = delete;
+    MemoryTransport& operator=(const MemoryTransport& other) = delete;
+    MemoryTransport(MemoryTransport&& other) = delete;
+    MemoryTransport& operator=(MemoryTransport&& other) = delete;
+
+    /** Get the address of the transport on the bus */
+    const asio::ip::address_v4& GetAddress() const { return address_; }
+
+    void Send(std::span<const AssembledMessage> messages) override;
+    void StartReceive(AsyncRecvBatchCallback callback) override;
+    void StopReceive() override;
+    std::uint32_t GetDroppedMessages() const override;
+    MetricsSnapshot GetMetricsSnapshot() const override;
+
+private:
+    MemoryBus& bus_;
+    std::shared_ptr<MemoryBus::Endpoint> endpoint_;
+    asio::ip::address_v4 address_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
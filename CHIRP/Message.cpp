@@ -1,20 +1,46 @@
 #include "Message.hpp"
 
 #include <algorithm>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "CHIRP/exceptions.hpp"
-#include "CHIRP/external/md5.h"
 
 using namespace cnstln::CHIRP;
 
-MD5Hash::MD5Hash(std::string_view string) {
-    auto hasher = Chocobo1::MD5();
-    hasher.addData(string.data(), string.length());
-    hasher.finalize();
-    // Swap output of hash with this to avoid copy
-    auto hash_copy = hasher.toArray();
-    this->swap(hash_copy);
+namespace {
+    /** Maximum number of strings in the MD5 hash cache */
+    constexpr std::size_t MD5_CACHE_SIZE = 4096;
+
+    /** Transparent string hash for heterogeneous lookup */
+    struct StringHash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view string) const noexcept { return std::hash<std::string_view>()(string); }
+    };
+} // namespace
+
+MD5Hash MD5Hash::Intern(std::string_view string) {
+    static std::shared_mutex cache_mutex {};
+    static std::unordered_map<std::string, MD5Hash, StringHash, std::equal_to<>> cache {};
+
+    {
+        const std::shared_lock cache_lock {cache_mutex};
+        const auto it = cache.find(string);
+        if (it != cache.end()) {
+            return it->second;
+        }
+    }
+    // Hash outside of the lock, concurrent callers might insert the same string
+    const MD5Hash hash {string};
+    const std::lock_guard cache_lock {cache_mutex};
+    if (cache.size() < MD5_CACHE_SIZE) {
+        cache.try_emplace(std::string(string), hash);
+    }
+    return hash;
 }
 
 std::string MD5Hash::to_string() const {
@@ -32,87 +58,18 @@ std::string MD5Hash::to_string() const {
     return ret;
 }
 
-bool MD5Hash::operator<(const MD5Hash& other) const {
-    for (std::uint8_t n = 0; n < this->size(); ++n) {
-        if (this->at(n) < other[n]) {
-            return true;
-        }
-    }
-    return false;
-}
-
-AssembledMessage::AssembledMessage(const std::vector<std::uint8_t>& byte_array) {
+AssembledMessage::AssembledMessage(std::span<const std::uint8_t> byte_array) {
     if (byte_array.size() != CHIRP_MESSAGE_LENGTH) {
         throw DecodeError("Message length is not " + std::to_string(CHIRP_MESSAGE_LENGTH) + " bytes");
     }
-    std::copy_n(byte_array.cbegin(), CHIRP_MESSAGE_LENGTH, this->begin());
+    std::copy_n(byte_array.begin(), CHIRP_MESSAGE_LENGTH, this->begin());
 }
 
-Message::Message(MessageType type, MD5Hash group_id, MD5Hash host_id, ServiceIdentifier service_id, Port port)
-  : type_(type), group_id_(std::move(group_id)), host_id_(std::move(host_id)), service_id_(service_id), port_(port) {}
-
 Message::Message(MessageType type, std::string_view group, std::string_view host, ServiceIdentifier service_id, Port port)
-  : Message(type, MD5Hash(group), MD5Hash(host), service_id, port) {}
+  : Message(type, MD5Hash::Intern(group), MD5Hash::Intern(host), service_id, port) {}
 
-Message::Message(const AssembledMessage& assembled_message) {
-    // Header
-    if (assembled_message[0] != 'C' ||
-        assembled_message[1] != 'H' ||
-        assembled_message[2] != 'I' ||
-        assembled_message[3] != 'R' ||
-        assembled_message[4] != 'P' ||
-        assembled_message[5] != CHIRP_VERSION) {
-        throw DecodeError("Not a CHIRP v1 broadcast");
-    }
-    // Message Type
-    if (assembled_message[6] < std::to_underlying(MessageType::REQUEST) ||
-        assembled_message[6] > std::to_underlying(MessageType::DEPART)) {
-        throw DecodeError("Message Type invalid");
-    }
-    type_ = static_cast<MessageType>(assembled_message[6]);
-    // Group ID
-    for (std::uint8_t n = 0; n < 16; ++n) {
-        group_id_[n] = assembled_message[7+n];
-    }
-    // Host ID
-    for (std::uint8_t n = 0; n < 16; ++n) {
-        host_id_[n] = assembled_message[23+n];
-    }
-    // Service Identifier
-    if (assembled_message[39] < std::to_underlying(ServiceIdentifier::CONTROL) ||
-        assembled_message[39] > std::to_underlying(ServiceIdentifier::DATA)) {
-        throw DecodeError("Service Identifier invalid");
-    }
-    service_id_ = static_cast<ServiceIdentifier>(assembled_message[39]);
-    // Port
-    port_ = assembled_message[40] + (static_cast<std::uint16_t>(assembled_message[41]) << 8);
-}
+Message::Message(const AssembledMessage& assembled_message)
+  : Message(std::span<const std::uint8_t, CHIRP_MESSAGE_LENGTH>(assembled_message)) {}
 
-AssembledMessage Message::Assemble() const {
-    AssembledMessage ret {};
-
-    // Header
-    ret[0] = 'C';
-    ret[1] = 'H';
-    ret[2] = 'I';
-    ret[3] = 'R';
-    ret[4] = 'P';
-    ret[5] = CHIRP_VERSION;
-    // Message Type
-    ret[6] = std::to_underlying(type_);
-    // Group Hash
-    for (std::uint8_t n = 0; n < 16; ++n) {
-        ret[7+n] = group_id_[n];
-    }
-    // Host Hash
-    for (std::uint8_t n = 0; n < 16; ++n) {
-        ret[23+n] = host_id_[n];
-    }
-    // Service Identifier
-    ret[39] = std::to_underlying(service_id_);
-    // Port
-    ret[40] = static_cast<std::uint8_t>(port_ & 0x00FF);
-    ret[41] = static_cast<std::uint8_t>((port_ >> 8) & 0x00FF);
-
-    return ret;
-}
+Message::Message(std::span<const std::uint8_t, CHIRP_MESSAGE_LENGTH> assembled_message)
+  : Message(Decode(assembled_message).value()) {}
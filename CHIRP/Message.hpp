@@ -1,28 +1,84 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
-#include <vector>
+#include <bit>
+#include <compare>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <span>
 #include <string>
 #include <string_view>
 
 #include "CHIRP/config.hpp"
+#include "CHIRP/exceptions.hpp"
+#include "CHIRP/external/md5.h"
 #include "CHIRP/protocol_info.hpp"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 namespace cnstln {
 namespace CHIRP {
 
-/** MD5 hash stored as array with 16 bytes */
+/**
+ * MD5 hash stored as array with 16 bytes
+ *
+ * Comparisons operate on two 64-bit words (or a single 128-bit vector compare for equality where SSE2 or NEON is
+ * available) instead of byte by byte. The ordering is lexicographic over the bytes.
+ */
 class MD5Hash : public std::array<std::uint8_t, 16> {
 public:
-    constexpr MD5Hash() {}
+    constexpr MD5Hash() : std::array<std::uint8_t, 16>() {}
 
     /**
      * Construct MD5 hash from a string
      *
+     * The hash can be computed at compile time, e.g. for literal group and host names (see also
+     * :cpp:func:`operator""_md5`). For names only known at runtime, see :cpp:func:`Intern`.
+     *
+     * @param string String from which to create the MD5 hash
+     */
+    constexpr MD5Hash(std::string_view string) : std::array<std::uint8_t, 16>() {
+        auto hasher = Chocobo1::MD5();
+        if (std::is_constant_evaluated()) {
+            // Characters cannot be reinterpreted as bytes in constant expressions, copy them in chunks
+            std::array<std::uint8_t, 64> chunk {};
+            for (std::size_t offset = 0; offset < string.size(); offset += chunk.size()) {
+                const auto length = std::min(chunk.size(), string.size() - offset);
+                for (std::size_t n = 0; n < length; ++n) {
+                    chunk[n] = static_cast<std::uint8_t>(string[offset + n]);
+                }
+                hasher.addData(std::span<const std::uint8_t>(chunk.data(), length));
+            }
+        }
+        else {
+            hasher.addData(string.data(), string.length());
+        }
+        hasher.finalize();
+        const auto hash = hasher.toArray();
+        std::copy(hash.begin(), hash.end(), this->begin());
+    }
+
+    /**
+     * Get the MD5 hash of a string from a process-wide cache
+     *
+     * The hash of a string is only computed the first time it is requested, which moves hashing out of hot paths for
+     * repeatedly used names, e.g. when creating many short-lived managers or messages with the same group and host
+     * name. The cache is thread-safe and limited in size, such that arbitrary names do not grow it without bound.
+     *
      * @param string String from which to create the MD5 hash
+     * @returns MD5 hash of the string
      */
-    CHIRP_API MD5Hash(std::string_view string);
+    CHIRP_API static MD5Hash Intern(std::string_view string);
 
     /**
      * Convert MD5 hash to an human readable string
@@ -31,21 +87,203 @@ public:
      */
     CHIRP_API std::string to_string() const;
 
-    CHIRP_API bool operator<(const MD5Hash& other) const;
+    /**
+     * Get the two 64-bit words of the hash in native byte order
+     *
+     * @returns Array with the first and second eight bytes of the hash
+     */
+    constexpr std::array<std::uint64_t, 2> words() const noexcept {
+        return std::bit_cast<std::array<std::uint64_t, 2>>(static_cast<const std::array<std::uint8_t, 16>&>(*this));
+    }
+
+    constexpr bool operator==(const MD5Hash& other) const noexcept {
+        if (!std::is_constant_evaluated()) {
+#if defined(__SSE2__)
+            const auto lhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data()));
+            const auto rhs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(other.data()));
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)) == 0xFFFF;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+            return vminvq_u8(vceqq_u8(vld1q_u8(data()), vld1q_u8(other.data()))) == 0xFF;
+#endif
+        }
+        const auto lhs = words();
+        const auto rhs = other.words();
+        return ((lhs[0] ^ rhs[0]) | (lhs[1] ^ rhs[1])) == 0;
+    }
+
+    constexpr std::strong_ordering operator<=>(const MD5Hash& other) const noexcept {
+        // Lexicographic byte order corresponds to the order of the big-endian words
+        const auto lhs_high = big_endian_word(0);
+        const auto rhs_high = other.big_endian_word(0);
+        if (lhs_high != rhs_high) {
+            return lhs_high <=> rhs_high;
+        }
+        return big_endian_word(8) <=> other.big_endian_word(8);
+    }
+
+private:
+    /** Load eight bytes starting at offset as big-endian word, compiles to a load and byte swap */
+    constexpr std::uint64_t big_endian_word(std::size_t offset) const noexcept {
+        std::uint64_t word = 0;
+        for (std::size_t n = 0; n < 8; ++n) {
+            word = (word << 8U) | (*this)[offset + n];
+        }
+        return word;
+    }
+};
+
+namespace literals {
+    /**
+     * Compute the MD5 hash of a string literal at compile time
+     *
+     * @param string String literal from which to create the MD5 hash
+     * @param length Length of the string literal
+     * @returns MD5 hash of the string literal
+     */
+    consteval MD5Hash operator""_md5(const char* string, std::size_t length) {
+        return MD5Hash(std::string_view(string, length));
+    }
+} // namespace literals
+
+/** Compile-time layout of the CHIRP wire format with offsets in bytes */
+struct MessageLayout {
+    /** Protocol identifier at the start of every CHIRP message */
+    static constexpr std::array<std::uint8_t, 5> IDENTIFIER {'C', 'H', 'I', 'R', 'P'};
+
+    /** Offset of the protocol identifier */
+    static constexpr std::size_t IDENTIFIER_OFFSET = 0;
+
+    /** Offset of the protocol version */
+    static constexpr std::size_t VERSION_OFFSET = IDENTIFIER_OFFSET + IDENTIFIER.size();
+
+    /** Offset of the :cpp:enum:`MessageType` */
+    static constexpr std::size_t TYPE_OFFSET = VERSION_OFFSET + sizeof(CHIRP_VERSION);
+
+    /** Offset of the group ID */
+    static constexpr std::size_t GROUP_ID_OFFSET = TYPE_OFFSET + sizeof(MessageType);
+
+    /** Offset of the host ID */
+    static constexpr std::size_t HOST_ID_OFFSET = GROUP_ID_OFFSET + sizeof(MD5Hash);
+
+    /** Offset of the :cpp:enum:`ServiceIdentifier` */
+    static constexpr std::size_t SERVICE_ID_OFFSET = HOST_ID_OFFSET + sizeof(MD5Hash);
+
+    /** Offset of the port in little-endian byte order */
+    static constexpr std::size_t PORT_OFFSET = SERVICE_ID_OFFSET + sizeof(ServiceIdentifier);
+
+    /**
+     * Copy bytes, using :cpp:func:`std::memcpy` outside of constant evaluation
+     *
+     * @param dest Destination of the bytes
+     * @param src Source of the bytes
+     * @param count Number of bytes to copy
+     */
+    static constexpr void CopyBytes(std::uint8_t* dest, const std::uint8_t* src, std::size_t count) {
+        if (std::is_constant_evaluated()) {
+            for (std::size_t n = 0; n < count; ++n) {
+                dest[n] = src[n];
+            }
+        }
+        else {
+            std::memcpy(dest, src, count);
+        }
+    }
+};
+static_assert(sizeof(MD5Hash) == 16);
+static_assert(MessageLayout::PORT_OFFSET + sizeof(Port) == CHIRP_MESSAGE_LENGTH);
+
+/** Result status when decoding a CHIRP message */
+enum class DecodeStatus : std::uint8_t {
+    /** The message was decoded successfully */
+    SUCCESS,
+
+    /** The message does not have a length of :cpp:var:`CHIRP_MESSAGE_LENGTH` bytes */
+    INVALID_LENGTH,
+
+    /** The message does not start with the CHIRP v1 header */
+    INVALID_HEADER,
+
+    /** The message has an unknown :cpp:enum:`MessageType` */
+    INVALID_TYPE,
+
+    /** The message has an unknown :cpp:enum:`ServiceIdentifier` */
+    INVALID_SERVICE_IDENTIFIER,
+};
+
+/**
+ * Get a human readable description of a decode status
+ *
+ * @param status Decode status
+ * @returns Description of the status, used as message for a :cpp:class:`DecodeError`
+ */
+constexpr std::string_view to_string(DecodeStatus status) {
+    switch (status) {
+    case DecodeStatus::SUCCESS: return "Success";
+    case DecodeStatus::INVALID_LENGTH: return "Message length is not 42 bytes";
+    case DecodeStatus::INVALID_HEADER: return "Not a CHIRP v1 broadcast";
+    case DecodeStatus::INVALID_TYPE: return "Message Type invalid";
+    case DecodeStatus::INVALID_SERVICE_IDENTIFIER: return "Service Identifier invalid";
+    default: return "Unknown decode status";
+    }
+}
+
+/**
+ * Result of decoding a CHIRP message, holding either a value or a :cpp:enum:`DecodeStatus`
+ *
+ * Follows the interface of :cpp:class:`std::expected` such that decoding untrusted input does not throw.
+ */
+template <typename T> class DecodeResult {
+public:
+    /** Construct successful result */
+    constexpr DecodeResult(T value) : value_(std::move(value)), status_(DecodeStatus::SUCCESS) {}
+
+    /** Construct failed result */
+    constexpr DecodeResult(DecodeStatus status) : status_(status) {}
+
+    /** Return whether the result holds a value */
+    constexpr bool has_value() const noexcept { return status_ == DecodeStatus::SUCCESS; }
+
+    /** Return whether the result holds a value */
+    constexpr explicit operator bool() const noexcept { return has_value(); }
+
+    /**
+     * Return the value
+     *
+     * @throws :cpp:class:`DecodeError` If the result does not hold a value
+     */
+    constexpr const T& value() const {
+        if (!has_value()) {
+            throw DecodeError(std::string(to_string(status_)));
+        }
+        return *value_;
+    }
+
+    /** Return the value, undefined if the result does not hold a value */
+    constexpr const T& operator*() const noexcept { return *value_; }
+
+    /** Access the value, undefined if the result does not hold a value */
+    constexpr const T* operator->() const noexcept { return &*value_; }
+
+    /** Return the decode status */
+    constexpr DecodeStatus error() const noexcept { return status_; }
+
+private:
+    std::optional<T> value_;
+    DecodeStatus status_;
 };
 
 /** CHIRP message assembled to array of bytes */
 class AssembledMessage : public std::array<std::uint8_t, CHIRP_MESSAGE_LENGTH> {
 public:
-    constexpr AssembledMessage() {}
+    constexpr AssembledMessage() : std::array<std::uint8_t, CHIRP_MESSAGE_LENGTH>() {}
 
     /**
      * Construct message from byte array with arbitrary length
      *
-     * @param byte_array Reference to byte array from which the message will be copied
+     * @param byte_array View of the byte array from which the message will be copied
      * @throws :cpp:class:`DecodeError` When the byte array has a different length than :cpp:var:`CHIRP_MESSAGE_LENGTH`
      */
-    CHIRP_API AssembledMessage(const std::vector<std::uint8_t>& byte_array);
+    CHIRP_API AssembledMessage(std::span<const std::uint8_t> byte_array);
 };
 
 /** CHIRP message */
@@ -60,14 +298,15 @@ public:
      * @param service_id
      * @param port
      */
-    CHIRP_API Message(MessageType type, MD5Hash group_id, MD5Hash host_id, ServiceIdentifier service_id, Port port);
+    constexpr Message(MessageType type, MD5Hash group_id, MD5Hash host_id, ServiceIdentifier service_id, Port port)
+      : type_(type), group_id_(std::move(group_id)), host_id_(std::move(host_id)), service_id_(service_id), port_(port) {}
 
     /**
      * Construct new CHIRP message using strings for group and host ID
      *
      * @param type
-     * @param group Name of the group (converted to group ID using :cpp:class:`MD5Hash`)
-     * @param host Name of the host (converted to host ID using :cpp:class:`MD5Hash`)
+     * @param group Name of the group (converted to group ID using :cpp:func:`MD5Hash::Intern`)
+     * @param host Name of the host (converted to host ID using :cpp:func:`MD5Hash::Intern`)
      * @param service_id
      * @param port
      */
@@ -82,6 +321,26 @@ public:
      */
     CHIRP_API Message(const AssembledMessage& assembled_message);
 
+    /**
+     * Constructor for a CHIRP message from a view of an assembled message
+     *
+     * This decodes the message directly from the given buffer without copying it to an :cpp:class:`AssembledMessage`
+     * first, e.g. from the buffer of a :cpp:struct:`BatchedBroadcastMessage`.
+     *
+     * @param assembled_message View of the assembled message
+     * @throws :cpp:class:`DecodeError` If the message header does not match the CHIRP specification, or if the message has
+     *         an unknown :cpp:enum:`MessageType` or :cpp:enum:`ServiceIdentifier`
+     */
+    CHIRP_API Message(std::span<const std::uint8_t, CHIRP_MESSAGE_LENGTH> assembled_message);
+
+    /**
+     * Decode a CHIRP message without throwing
+     *
+     * @param bytes View of the received bytes
+     * @returns Decoded message, or the :cpp:enum:`DecodeStatus` if the bytes are not a valid CHIRP message
+     */
+    static constexpr DecodeResult<Message> Decode(std::span<const std::uint8_t> bytes) noexcept;
+
     /** Return the message type */
     constexpr MessageType GetType() const { return type_; }
 
@@ -98,7 +357,18 @@ public:
     constexpr Port GetPort() const { return port_; }
 
     /** Assemble message to byte array */
-    CHIRP_API AssembledMessage Assemble() const;
+    constexpr AssembledMessage Assemble() const {
+        AssembledMessage ret {};
+        MessageLayout::CopyBytes(&ret[MessageLayout::IDENTIFIER_OFFSET], MessageLayout::IDENTIFIER.data(), MessageLayout::IDENTIFIER.size());
+        ret[MessageLayout::VERSION_OFFSET] = CHIRP_VERSION;
+        ret[MessageLayout::TYPE_OFFSET] = std::to_underlying(type_);
+        MessageLayout::CopyBytes(&ret[MessageLayout::GROUP_ID_OFFSET], group_id_.data(), group_id_.size());
+        MessageLayout::CopyBytes(&ret[MessageLayout::HOST_ID_OFFSET], host_id_.data(), host_id_.size());
+        ret[MessageLayout::SERVICE_ID_OFFSET] = std::to_underlying(service_id_);
+        ret[MessageLayout::PORT_OFFSET] = static_cast<std::uint8_t>(port_ & 0x00FF);
+        ret[MessageLayout::PORT_OFFSET + 1] = static_cast<std::uint8_t>((port_ >> 8) & 0x00FF);
+        return ret;
+    }
 
 private:
     MessageType type_;
@@ -108,5 +378,149 @@ private:
     Port port_;
 };
 
+/**
+ * Builder for assembled CHIRP messages with fixed group and host ID
+ *
+ * The builder assembles the header, group ID and host ID once, such that building a message only sets the message type,
+ * service identifier and port. This moves hashing and assembling of the IDs out of the send path.
+ */
+class MessageBuilder {
+public:
+    /**
+     * @param group_id Group ID of all built messages
+     * @param host_id Host ID of all built messages
+     */
+    constexpr MessageBuilder(const MD5Hash& group_id, const MD5Hash& host_id)
+      : prototype_(Message(REQUEST, group_id, host_id, CONTROL, 0).Assemble()) {}
+
+    /**
+     * Build an assembled CHIRP message
+     *
+     * @param type Message type
+     * @param service_id Service identifier
+     * @param port Port of the service
+     * @returns Assembled message, identical to :cpp:func:`Message::Assemble` with the same fields
+     */
+    constexpr AssembledMessage Build(MessageType type, ServiceIdentifier service_id, Port port) const {
+        auto ret = prototype_;
+        ret[MessageLayout::TYPE_OFFSET] = std::to_underlying(type);
+        ret[MessageLayout::SERVICE_ID_OFFSET] = std::to_underlying(service_id);
+        ret[MessageLayout::PORT_OFFSET] = static_cast<std::uint8_t>(port & 0x00FF);
+        ret[MessageLayout::PORT_OFFSET + 1] = static_cast<std::uint8_t>((port >> 8) & 0x00FF);
+        return ret;
+    }
+
+    /**
+     * Change the message type of an assembled CHIRP message
+     *
+     * @param asm_msg Assembled message, e.g. an OFFER
+     * @param type New message type, e.g. DEPART
+     * @returns Assembled message with the new message type
+     */
+    static constexpr AssembledMessage WithType(const AssembledMessage& asm_msg, MessageType type) {
+        auto ret = asm_msg;
+        ret[MessageLayout::TYPE_OFFSET] = std::to_underlying(type);
+        return ret;
+    }
+
+private:
+    AssembledMessage prototype_;
+};
+
+/**
+ * View of an assembled CHIRP message
+ *
+ * The view validates the message once and then reads the fields in place from the underlying buffer, e.g. the receive
+ * buffer of a :cpp:struct:`BatchedBroadcastMessage`. This allows to filter messages, e.g. by group ID, before copying
+ * them into a :cpp:class:`Message`. The buffer needs to outlive the view.
+ */
+class MessageView {
+public:
+    /**
+     * Validate bytes and create a view
+     *
+     * @param bytes View of the received bytes
+     * @returns View of the message, or the :cpp:enum:`DecodeStatus` if the bytes are not a valid CHIRP message
+     */
+    static constexpr DecodeResult<MessageView> Decode(std::span<const std::uint8_t> bytes) noexcept {
+        if (bytes.size() != CHIRP_MESSAGE_LENGTH) {
+            return DecodeStatus::INVALID_LENGTH;
+        }
+        for (std::size_t n = 0; n < MessageLayout::IDENTIFIER.size(); ++n) {
+            if (bytes[MessageLayout::IDENTIFIER_OFFSET + n] != MessageLayout::IDENTIFIER[n]) {
+                return DecodeStatus::INVALID_HEADER;
+            }
+        }
+        if (bytes[MessageLayout::VERSION_OFFSET] != CHIRP_VERSION) {
+            return DecodeStatus::INVALID_HEADER;
+        }
+        const auto type = bytes[MessageLayout::TYPE_OFFSET];
+        if (type < std::to_underlying(MessageType::REQUEST) || type > std::to_underlying(MessageType::DEPART)) {
+            return DecodeStatus::INVALID_TYPE;
+        }
+        const auto service_id = bytes[MessageLayout::SERVICE_ID_OFFSET];
+        if (service_id < std::to_underlying(ServiceIdentifier::CONTROL) ||
+            service_id > std::to_underlying(ServiceIdentifier::DATA)) {
+            return DecodeStatus::INVALID_SERVICE_IDENTIFIER;
+        }
+        return MessageView(bytes.first<CHIRP_MESSAGE_LENGTH>());
+    }
+
+    /** Return the message type */
+    constexpr MessageType GetType() const { return static_cast<MessageType>(bytes_[MessageLayout::TYPE_OFFSET]); }
+
+    /** Return the group ID of the message */
+    constexpr MD5Hash GetGroupID() const { return LoadHash(MessageLayout::GROUP_ID_OFFSET); }
+
+    /** Return the host ID of the message */
+    constexpr MD5Hash GetHostID() const { return LoadHash(MessageLayout::HOST_ID_OFFSET); }
+
+    /** Return the service identifier of the message */
+    constexpr ServiceIdentifier GetServiceIdentifier() const {
+        return static_cast<ServiceIdentifier>(bytes_[MessageLayout::SERVICE_ID_OFFSET]);
+    }
+
+    /** Return the service port of the message */
+    constexpr Port GetPort() const {
+        return static_cast<Port>(bytes_[MessageLayout::PORT_OFFSET] |
+                                 (static_cast<std::uint16_t>(bytes_[MessageLayout::PORT_OFFSET + 1]) << 8));
+    }
+
+    /** Copy the fields into a message */
+    constexpr Message ToMessage() const {
+        return {GetType(), GetGroupID(), GetHostID(), GetServiceIdentifier(), GetPort()};
+    }
+
+private:
+    constexpr MessageView(std::span<const std::uint8_t, CHIRP_MESSAGE_LENGTH> bytes) : bytes_(bytes) {}
+
+    constexpr MD5Hash LoadHash(std::size_t offset) const {
+        MD5Hash ret {};
+        MessageLayout::CopyBytes(ret.data(), &bytes_[offset], ret.size());
+        return ret;
+    }
+
+private:
+    std::span<const std::uint8_t, CHIRP_MESSAGE_LENGTH> bytes_;
+};
+
+constexpr DecodeResult<Message> Message::Decode(std::span<const std::uint8_t> bytes) noexcept {
+    const auto view = MessageView::Decode(bytes);
+    if (!view) {
+        return view.error();
+    }
+    return view->ToMessage();
+}
+
 } // namespace CHIRP
 } // namespace cnstln
+
+/** Hash function for :cpp:class:`MD5Hash`, e.g. for use in :cpp:class:`std::unordered_map` */
+template <>
+struct std::hash<cnstln::CHIRP::MD5Hash> {
+    constexpr std::size_t operator()(const cnstln::CHIRP::MD5Hash& md5_hash) const noexcept {
+        // MD5 hashes are uniformly distributed, thus folding the two 64-bit words is sufficient
+        const auto words = md5_hash.words();
+        return static_cast<std::size_t>(words[0] ^ words[1]);
+    }
+};
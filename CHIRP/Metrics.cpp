@@ -0,0 +1,141 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using namespace cnstln::CHIRP;
+
+namespace {
+    /** Names of the counters in the Prometheus export */
+    constexpr std::array<std::string_view, METRIC_COUNTER_COUNT> COUNTER_NAMES {
+        "datagrams_received",
+        "dropped_length",
+        "dropped_duplicate",
+        "dropped_decode_error",
+        "dropped_foreign_group",
+        "dropped_self",
+        "requests_received",
+        "offers_received",
+        "departs_received",
+        "offers_sent",
+        "callbacks_dispatched",
+        "messages_sent",
+        "send_queue_overflows",
+        "send_errors",
+        "receive_errors",
+    };
+
+    /** Names of the histograms in the Prometheus export */
+    constexpr std::array<std::string_view, METRIC_HISTOGRAM_COUNT> HISTOGRAM_NAMES {
+        "decode_time",
+        "lock_hold_time",
+        "callback_queue_delay",
+    };
+
+    /** Exclusive upper bound of a histogram bucket in nanoseconds */
+    std::uint64_t bucket_bound(std::size_t bucket) {
+        return std::uint64_t(1) << bucket;
+    }
+
+    /** Format nanoseconds as exact decimal seconds, such that every bucket bound has a unique label */
+    std::string format_seconds(std::uint64_t nanoseconds) {
+        auto out = std::to_string(nanoseconds / 1000000000);
+        auto fraction = std::to_string(nanoseconds % 1000000000);
+        fraction.insert(0, 9 - fraction.size(), '0');
+        fraction.erase(fraction.find_last_not_of('0') + 1);
+        if (!fraction.empty()) {
+            out += "." + fraction;
+        }
+        return out;
+    }
+} // namespace
+
+std::chrono::nanoseconds MetricsSnapshot::Histogram::Quantile(double quantile) const {
+    if (count == 0) {
+        return std::chrono::nanoseconds::zero();
+    }
+    // Rank of the quantile, at least the first recorded duration
+    const auto rank = std::max<std::uint64_t>(
+        static_cast<std::uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(count))), 1);
+    std::uint64_t cumulative = 0;
+    for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        cumulative += buckets[bucket];
+        if (cumulative >= rank) {
+            return std::chrono::nanoseconds(bucket_bound(bucket));
+        }
+    }
+    return std::chrono::nanoseconds(bucket_bound(buckets.size() - 1));
+}
+
+MetricsSnapshot& MetricsSnapshot::operator+=(const MetricsSnapshot& other) {
+    for (std::size_t n = 0; n < counters.size(); ++n) {
+        counters[n] += other.counters[n];
+    }
+    for (std::size_t n = 0; n < histograms.size(); ++n) {
+        for (std::size_t bucket = 0; bucket < METRIC_HISTOGRAM_BUCKETS; ++bucket) {
+            histograms[n].buckets[bucket] += other.histograms[n].buckets[bucket];
+        }
+        histograms[n].count += other.histograms[n].count;
+        histograms[n].sum += other.histograms[n].sum;
+    }
+    return *this;
+}
+
+std::string MetricsSnapshot::ToPrometheus(std::string_view prefix) const {
+    std::string out {};
+    for (std::size_t n = 0; n < counters.size(); ++n) {
+        const auto name = std::string(prefix) + "_" + std::string(COUNTER_NAMES[n]) + "_total";
+        out += "# TYPE " + name + " counter\n";
+        out += name + " " + std::to_string(counters[n]) + "\n";
+    }
+    for (std::size_t n = 0; n < histograms.size(); ++n) {
+        const auto& histogram = histograms[n];
+        const auto name = std::string(prefix) + "_" + std::string(HISTOGRAM_NAMES[n]) + "_seconds";
+        out += "# TYPE " + name + " histogram\n";
+        // Buckets are cumulative, the last bucket is only covered by +Inf
+        std::uint64_t cumulative = 0;
+        for (std::size_t bucket = 0; bucket + 1 < METRIC_HISTOGRAM_BUCKETS; ++bucket) {
+            cumulative += histogram.buckets[bucket];
+            const auto bound = format_seconds(bucket_bound(bucket));
+            out += name + "_bucket{le=\"" + bound + "\"} " + std::to_string(cumulative) + "\n";
+        }
+        out += name + "_bucket{le=\"+Inf\"} " + std::to_string(histogram.count) + "\n";
+        out += name + "_sum " + format_seconds(histogram.sum) + "\n";
+        out += name + "_count " + std::to_string(histogram.count) + "\n";
+    }
+    return out;
+}
+
+MetricsSnapshot Metrics::Snapshot() const {
+    MetricsSnapshot snapshot {};
+#ifdef CHIRP_METRICS
+    for (const auto& shard : shards_) {
+        for (std::size_t n = 0; n < METRIC_COUNTER_COUNT; ++n) {
+            snapshot.counters[n] += shard.counters[n].load(std::memory_order_relaxed);
+        }
+        for (std::size_t n = 0; n < METRIC_HISTOGRAM_COUNT; ++n) {
+            auto& histogram = snapshot.histograms[n];
+            for (std::size_t bucket = 0; bucket < METRIC_HISTOGRAM_BUCKETS; ++bucket) {
+                const auto value = shard.histograms[n].buckets[bucket].load(std::memory_order_relaxed);
+                histogram.buckets[bucket] += value;
+                histogram.count += value;
+            }
+            histogram.sum += shard.histograms[n].sum.load(std::memory_order_relaxed);
+        }
+    }
+#endif
+    return snapshot;
+}
+
+std::size_t Metrics::ShardIndex() {
+    // Assign shards round-robin on first use per thread
+    static std::atomic_size_t next_index {0};
+    thread_local const std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+    return index;
+}
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "CHIRP/config.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/** Counters of the hot paths, see :cpp:class:`Metrics` */
+enum class MetricCounter : std::size_t {
+    /** Datagrams received by a :cpp:class:`BroadcastRecv` */
+    DATAGRAMS_RECEIVED,
+    /** Datagrams dropped by a :cpp:class:`Demultiplexer` since they have the wrong length for a CHIRP message */
+    DROPPED_LENGTH,
+    /** Datagrams dropped by a :cpp:class:`Demultiplexer` as duplicates, see :cpp:class:`DuplicateFilter` */
+    DROPPED_DUPLICATE,
+    /** Datagrams dropped by a :cpp:class:`Demultiplexer` since they could not be decoded */
+    DROPPED_DECODE_ERROR,
+    /** Datagrams dropped by a :cpp:class:`Demultiplexer` since no manager of their group is registered */
+    DROPPED_FOREIGN_GROUP,
+    /** Datagrams dropped by a :cpp:class:`Demultiplexer` since they were sent by the receiving manager itself */
+    DROPPED_SELF,
+    /** REQUESTs handled by a :cpp:class:`Manager` */
+    REQUESTS_RECEIVED,
+    /** OFFERs handled by a :cpp:class:`Manager` */
+    OFFERS_RECEIVED,
+    /** DEPARTs handled by a :cpp:class:`Manager` */
+    DEPARTS_RECEIVED,
+    /** OFFERs broadcast by a :cpp:class:`Manager` in reply to REQUESTs or as announcement */
+    OFFERS_SENT,
+    /** Discovery callbacks dispatched by a :cpp:class:`Manager` */
+    CALLBACKS_DISPATCHED,
+    /** Messages sent by a :cpp:class:`BroadcastSend`, counted once per socket */
+    MESSAGES_SENT,
+    /** Messages dropped by a :cpp:class:`BroadcastSend` since the asynchronous send queue was full */
+    SEND_QUEUE_OVERFLOWS,
+    /** Asynchronous sends of a :cpp:class:`BroadcastSend` which failed */
+    SEND_ERRORS,
+    /** Continuous receives of a :cpp:class:`BroadcastRecv` which failed and were retried after a back-off */
+    RECEIVE_ERRORS,
+};
+
+/** Number of :cpp:enum:`MetricCounter` values */
+inline constexpr std::size_t METRIC_COUNTER_COUNT = 15;
+
+/** Histograms of durations on the hot paths, see :cpp:class:`Metrics` */
+enum class MetricHistogram : std::size_t {
+    /** Time to validate and decode a datagram in a :cpp:class:`Demultiplexer` */
+    DECODE_TIME,
+    /** Time the discovered services of a :cpp:class:`Manager` are locked to handle an OFFER or DEPART */
+    LOCK_HOLD_TIME,
+    /** Time between dispatching a discovery callback and its execution */
+    CALLBACK_QUEUE_DELAY,
+};
+
+/** Number of :cpp:enum:`MetricHistogram` values */
+inline constexpr std::size_t METRIC_HISTOGRAM_COUNT = 3;
+
+/** Number of buckets of a histogram, bucket n counts durations below 2^n nanoseconds, the last bucket all others */
+inline constexpr std::size_t METRIC_HISTOGRAM_BUCKETS = 32;
+
+/** Point-in-time values of :cpp:class:`Metrics` */
+struct MetricsSnapshot {
+    /** Snapshot of a histogram */
+    struct Histogram {
+        /** Number of recorded durations per bucket */
+        std::array<std::uint64_t, METRIC_HISTOGRAM_BUCKETS> buckets;
+        /** Number of recorded durations */
+        std::uint64_t count;
+        /** Sum of the recorded durations in nanoseconds */
+        std::uint64_t sum;
+
+        /**
+         * Estimate a quantile of the recorded durations
+         *
+         * @param quantile Quantile between zero and one
+         * @return Upper bound of the bucket containing the quantile, zero if no durations were recorded
+         */
+        CHIRP_API std::chrono::nanoseconds Quantile(double quantile) const;
+    };
+
+    /** Values of the counters, indexed by :cpp:enum:`MetricCounter` */
+    std::array<std::uint64_t, METRIC_COUNTER_COUNT> counters;
+
+    /** Values of the histograms, indexed by :cpp:enum:`MetricHistogram` */
+    std::array<Histogram, METRIC_HISTOGRAM_COUNT> histograms;
+
+    /** Return the value of a counter */
+    std::uint64_t operator[](MetricCounter counter) const { return counters[std::to_underlying(counter)]; }
+
+    /** Return the snapshot of a histogram */
+    const Histogram& operator[](MetricHistogram histogram) const { return histograms[std::to_underlying(histogram)]; }
+
+    /** Add the values of another snapshot, e.g. to combine the metrics of several components */
+    CHIRP_API MetricsSnapshot& operator+=(const MetricsSnapshot& other);
+
+    /**
+     * Export the snapshot in the Prometheus text exposition format
+     *
+     * Counters are exported as ``<prefix>_<name>_total``, histograms as ``<prefix>_<name>_seconds`` with cumulative
+     * buckets.
+     *
+     * @param prefix Prefix of the metric names
+     * @return Metrics in Prometheus text format
+     */
+    CHIRP_API std::string ToPrometheus(std::string_view prefix = "chirp") const;
+};
+
+/**
+ * Low-overhead counters and duration histograms of a component
+ *
+ * Values are recorded with relaxed atomic operations into one of several cache-line aligned shards chosen per thread,
+ * such that threads recording concurrently do not contend on the same cache line. Reading the values via
+ * :cpp:func:`Snapshot` sums all shards and does not block recording threads.
+ *
+ * Metrics are only recorded if the library is built with ``CHIRP_METRICS`` defined (meson option ``metrics``).
+ * Otherwise all recording functions are empty inline functions, no clock is read and the snapshot is all zero.
+ */
+class Metrics {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /** Whether metrics are compiled in */
+#ifdef CHIRP_METRICS
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    /** Number of shards */
+    static constexpr std::size_t SHARDS = 8;
+
+    /** Timer recording the duration of a scope into a histogram */
+    class ScopedTimer {
+    public:
+        ScopedTimer(Metrics& metrics, MetricHistogram histogram)
+          : metrics_(metrics), histogram_(histogram), start_(Metrics::Now()) {}
+        ~ScopedTimer() { metrics_.RecordSince(histogram_, start_); }
+
+        // No copy/move constructor/assignment
+        ScopedTimer(const ScopedTimer& other) = delete;
+        ScopedTimer& operator=(const ScopedTimer& other) = delete;
+        ScopedTimer(ScopedTimer&& other) = delete;
+        ScopedTimer& operator=(ScopedTimer&& other) = delete;
+
+    private:
+        Metrics& metrics_;
+        MetricHistogram histogram_;
+        clock::time_point start_;
+    };
+
+    /**
+     * Increment a counter
+     *
+     * @param counter Counter to increment
+     * @param value Value to add
+     */
+    void Increment([[maybe_unused]] MetricCounter counter, [[maybe_unused]] std::uint64_t value = 1) {
+#ifdef CHIRP_METRICS
+        shards_[ShardIndex()].counters[std::to_underlying(counter)].fetch_add(value, std::memory_order_relaxed);
+#endif
+    }
+
+    /**
+     * Record a duration into a histogram
+     *
+     * @param histogram Histogram to record into
+     * @param duration Duration to record
+     */
+    void Record([[maybe_unused]] MetricHistogram histogram, [[maybe_unused]] clock::duration duration) {
+#ifdef CHIRP_METRICS
+        const auto ns = static_cast<std::uint64_t>(std::max(std::chrono::nanoseconds(duration).count(), std::chrono::nanoseconds::rep(0)));
+        const auto bucket = std::min<std::size_t>(std::bit_width(ns), METRIC_HISTOGRAM_BUCKETS - 1);
+        auto& shard_histogram = shards_[ShardIndex()].histograms[std::to_underlying(histogram)];
+        shard_histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        shard_histogram.sum.fetch_add(ns, std::memory_order_relaxed);
+#endif
+    }
+
+    /**
+     * Record the duration since a start time into a histogram
+     *
+     * @param histogram Histogram to record into
+     * @param start Start time obtained via :cpp:func:`Now`
+     */
+    void RecordSince(MetricHistogram histogram, clock::time_point start) {
+        if constexpr (ENABLED) {
+            Record(histogram, clock::now() - start);
+        }
+    }
+
+    /** Return the current time if metrics are enabled, otherwise a default time point without reading the clock */
+    static clock::time_point Now() {
+        if constexpr (ENABLED) {
+            return clock::now();
+        }
+        return {};
+    }
+
+    /**
+     * Get the current values of all counters and histograms
+     *
+     * @return Snapshot of the metrics
+     */
+    CHIRP_API MetricsSnapshot Snapshot() const;
+
+private:
+    /** Shard of a histogram */
+    struct HistogramShard {
+        std::array<std::atomic<std::uint64_t>, METRIC_HISTOGRAM_BUCKETS> buckets {};
+        std::atomic<std::uint64_t> sum {};
+    };
+
+    /** Values recorded by a subset of the threads */
+    struct alignas(64) Shard {
+        std::array<std::atomic<std::uint64_t>, METRIC_COUNTER_COUNT> counters {};
+        std::array<HistogramShard, METRIC_HISTOGRAM_COUNT> histograms {};
+    };
+
+    /** Index of the shard of the calling thread */
+    CHIRP_API static std::size_t ShardIndex();
+
+private:
+#ifdef CHIRP_METRICS
+    std::array<Shard, SHARDS> shards_ {};
+#endif
+};
+
+} // namespace CHIRP
+} // namespace cnstln
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "asio.hpp"
+
+#include "CHIRP/Message.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * Multicast address of a CHIRP group
+ *
+ * Each group is mapped to its own multicast address derived from the group ID, such that hosts only join the groups
+ * they are interested in and network interfaces can drop the traffic of other groups. IPv4 addresses are taken from the
+ * organization-local scope 239.192.0.0/14 (RFC 2365), using the lower 18 bits of the group ID. These bits also end up
+ * in the multicast MAC address, which is used for filtering by the network interface. IPv6 addresses use the
+ * site-local scope of transient multicast addresses ff15::/16 with the first 14 bytes of the group ID.
+ *
+ * @param group_id Group ID of the group
+ * @param ipv6 Whether to return an IPv6 address instead of an IPv4 address
+ * @return Multicast address of the group
+ */
+inline asio::ip::address MulticastAddress(const MD5Hash& group_id, bool ipv6 = false) {
+    if (ipv6) {
+        asio::ip::address_v6::bytes_type bytes {};
+        bytes[0] = 0xFF;
+        bytes[1] = 0x15;
+        std::copy_n(group_id.begin(), bytes.size() - 2, bytes.begin() + 2);
+        return asio::ip::address_v6(bytes);
+    }
+    const auto group_bits = ((static_cast<std::uint32_t>(group_id[13]) << 16U) |
+                             (static_cast<std::uint32_t>(group_id[14]) << 8U) | group_id[15]) &
+                            0x0003FFFFU;
+    return asio::ip::address_v4((239U << 24U) | (192U << 16U) | group_bits);
+}
+
+} // namespace CHIRP
+} // namespace cnstln
@@ -0,0 +1,73 @@
+#include "NetworkInterface.hpp"
+
+#include <cstdint>
+#include <memory>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <iphlpapi.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#endif
+
+using namespace cnstln::CHIRP;
+
+namespace {
+    /** Convert IPv4 socket address to asio address */
+    asio::ip::address_v4 to_address(const sockaddr* socket_address) {
+        const auto* address_in = reinterpret_cast<const sockaddr_in*>(socket_address);
+        return asio::ip::address_v4(ntohl(address_in->sin_addr.s_addr));
+    }
+} // namespace
+
+std::vector<NetworkInterface> cnstln::CHIRP::GetNetworkInterfaces() {
+    std::vector<NetworkInterface> interfaces {};
+#if defined(_WIN32)
+    // Query size of the adapter list first, then the list itself
+    ULONG size = 0;
+    constexpr ULONG flags = GAA_FLAG_SKIP_ANYCAST | GAA_FLAG_SKIP_MULTICAST | GAA_FLAG_SKIP_DNS_SERVER;
+    if (GetAdaptersAddresses(AF_INET, flags, nullptr, nullptr, &size) != ERROR_BUFFER_OVERFLOW) {
+        return interfaces;
+    }
+    auto buffer = std::make_unique<std::uint8_t[]>(size);
+    auto* adapters = reinterpret_cast<IP_ADAPTER_ADDRESSES*>(buffer.get());
+    if (GetAdaptersAddresses(AF_INET, flags, nullptr, adapters, &size) != NO_ERROR) {
+        return interfaces;
+    }
+    for (const auto* adapter = adapters; adapter != nullptr; adapter = adapter->Next) {
+        if (adapter->OperStatus != IfOperStatusUp || adapter->IfType == IF_TYPE_SOFTWARE_LOOPBACK) {
+            continue;
+        }
+        for (const auto* unicast = adapter->FirstUnicastAddress; unicast != nullptr; unicast = unicast->Next) {
+            // Windows does not report broadcast addresses, derive them from the prefix length
+            const auto address = to_address(unicast->Address.lpSockaddr);
+            const auto prefix = unicast->OnLinkPrefixLength;
+            const auto host_mask = prefix >= 32 ? std::uint32_t(0) : std::uint32_t(0xFFFFFFFF) >> prefix;
+            const auto broadcast_address = asio::ip::address_v4(address.to_uint() | host_mask);
+            interfaces.emplace_back(std::string(adapter->AdapterName), address, broadcast_address);
+        }
+    }
+#else
+    ifaddrs* ifaddr_list = nullptr;
+    if (getifaddrs(&ifaddr_list) != 0) {
+        return interfaces;
+    }
+    // Free list also if constructing the entries throws
+    const std::unique_ptr<ifaddrs, decltype(&freeifaddrs)> ifaddr_guard {ifaddr_list, &freeifaddrs};
+    for (const auto* ifaddr = ifaddr_list; ifaddr != nullptr; ifaddr = ifaddr->ifa_next) {
+        if (ifaddr->ifa_addr == nullptr || ifaddr->ifa_addr->sa_family != AF_INET) {
+            continue;
+        }
+        if ((ifaddr->ifa_flags & IFF_UP) == 0 || (ifaddr->ifa_flags & IFF_BROADCAST) == 0 ||
+            (ifaddr->ifa_flags & IFF_LOOPBACK) != 0 || ifaddr->ifa_broadaddr == nullptr) {
+            continue;
+        }
+        interfaces.emplace_back(ifaddr->ifa_name, to_address(ifaddr->ifa_addr), to_address(ifaddr->ifa_broadaddr));
+    }
+#endif
+    return interfaces;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "CHIRP/config.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/** Local network interface capable of sending broadcasts */
+struct NetworkInterface {
+    /** Name of the interface */
+    std::string name;
+
+    /** Address of the host on the interface */
+    asio::ip::address address;
+
+    /** Broadcast address of the subnet of the interface */
+    asio::ip::address broadcast_address;
+};
+
+/**
+ * List the local network interfaces which are up and support broadcasts
+ *
+ * Only IPv4 addresses are listed, since IPv6 does not support broadcasts. An interface with several IPv4 addresses is
+ * listed once per address. Loopback interfaces are not listed (see README for broadcasting over localhost).
+ *
+ * This uses ``getifaddrs`` on POSIX systems and ``GetAdaptersAddresses`` on Windows.
+ *
+ * @return List of network interfaces with their broadcast addresses
+ */
+CHIRP_API std::vector<NetworkInterface> GetNetworkInterfaces();
+
+} // namespace CHIRP
+} // namespace cnstln
@@ -0,0 +1,78 @@
+#include "SocketOptions.hpp"
+
+#include <cstddef>
+
+#if !defined(_WIN32)
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+using namespace cnstln::CHIRP;
+
+namespace {
+    /** Integer socket option not provided by asio */
+    template <int Level, int Name>
+    class integer_option {
+    public:
+        explicit integer_option(int value) : value_(value) {}
+
+        template <typename Protocol>
+        int level(const Protocol& /*protocol*/) const {
+            return Level;
+        }
+
+        template <typename Protocol>
+        int name(const Protocol& /*protocol*/) const {
+            return Name;
+        }
+
+        template <typename Protocol>
+        const int* data(const Protocol& /*protocol*/) const {
+            return &value_;
+        }
+
+        template <typename Protocol>
+        std::size_t size(const Protocol& /*protocol*/) const {
+            return sizeof(value_);
+        }
+
+    private:
+        int value_;
+    };
+} // namespace
+
+void SocketOptions::Apply(asio::ip::udp::socket& socket) const {
+    if (receive_buffer_size > 0) {
+        socket.set_option(asio::socket_base::receive_buffer_size(receive_buffer_size));
+    }
+    if (send_buffer_size > 0) {
+        socket.set_option(asio::socket_base::send_buffer_size(send_buffer_size));
+    }
+#if defined(SO_REUSEPORT)
+    if (reuse_port) {
+        socket.set_option(integer_option<SOL_SOCKET, SO_REUSEPORT>(1));
+    }
+#endif
+#if defined(SO_BUSY_POLL)
+    if (busy_poll.count() > 0) {
+        socket.set_option(integer_option<SOL_SOCKET, SO_BUSY_POLL>(static_cast<int>(busy_poll.count())));
+    }
+#endif
+#if !defined(_WIN32)
+    if (dscp >= 0) {
+        // DSCP occupies the upper six bits of the traffic class
+        const auto traffic_class = (dscp & 0x3F) << 2;
+        if (socket.local_endpoint().protocol() == asio::ip::udp::v6()) {
+            socket.set_option(integer_option<IPPROTO_IPV6, IPV6_TCLASS>(traffic_class));
+        }
+        else {
+            socket.set_option(integer_option<IPPROTO_IP, IP_TOS>(traffic_class));
+        }
+    }
+#endif
+#if defined(SO_PRIORITY)
+    if (priority >= 0) {
+        socket.set_option(integer_option<SOL_SOCKET, SO_PRIORITY>(priority));
+    }
+#endif
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+
+#include "asio.hpp"
+
+#include "CHIRP/config.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * Tuning options for the sockets of :cpp:class:`BroadcastRecv` and :cpp:class:`BroadcastSend`
+ *
+ * All options default to the system defaults. Options which are not supported on the platform are ignored, while
+ * options rejected by the system, e.g. due to missing privileges, throw an :cpp:class:`asio::system_error`.
+ */
+struct SocketOptions {
+    /**
+     * Size of the kernel receive buffer in bytes, zero for the system default
+     *
+     * A larger buffer avoids dropping messages during bursts, e.g. the OFFERs of all hosts at startup. On Linux, the size
+     * is limited by ``net.core.rmem_max``.
+     */
+    int receive_buffer_size {0};
+
+    /** Size of the kernel send buffer in bytes, zero for the system default */
+    int send_buffer_size {0};
+
+    /** Whether to set ``SO_REUSEPORT`` in addition to ``SO_REUSEADDR`` */
+    bool reuse_port {false};
+
+    /**
+     * Busy polling duration for blocking receives via ``SO_BUSY_POLL`` (Linux only), zero to disable
+     *
+     * Increasing the value above the system default requires ``CAP_NET_ADMIN``.
+     */
+    std::chrono::microseconds busy_poll {0};
+
+    /** Differentiated services code point for outgoing messages (0-63), negative for the system default */
+    int dscp {-1};
+
+    /** Priority of outgoing messages for queueing via ``SO_PRIORITY`` (Linux only), negative for the system default */
+    int priority {-1};
+
+    /**
+     * Whether to receive via a spin-polling loop on a dedicated thread instead of waiting in the IO context
+     *
+     * This minimizes the latency between an incoming message and its handling at the cost of one fully used CPU core.
+     * Only used for the receiving socket of a :cpp:class:`Demultiplexer`.
+     */
+    bool spin_poll {false};
+
+    /** CPU to pin the spin-polling thread to (Linux only), negative to not pin the thread */
+    int spin_poll_cpu {-1};
+
+    /**
+     * Apply the options to an open socket
+     *
+     * Needs to be called before binding the socket for :cpp:member:`reuse_port` to take effect.
+     *
+     * @param socket Socket to configure
+     */
+    CHIRP_API void Apply(asio::ip::udp::socket& socket) const;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
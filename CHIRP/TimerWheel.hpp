@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * Hierarchical timer wheel
+ *
+ * The wheel consists of several levels of 64 slots each, where a slot of level n spans 64^n ticks. Values are placed
+ * into the lowest level that can hold their deadline and cascade to lower levels as time advances, such that
+ * scheduling is constant time and advancing only touches the slots that are due. Deadlines beyond the range of the
+ * highest level are clamped to its end.
+ *
+ * Values cannot be cancelled. Instead, the owner is expected to check on expiry whether the value is still relevant
+ * and to reschedule it if the deadline was extended in the meantime.
+ *
+ * The wheel is not thread-safe.
+ *
+ * @tparam T Type of the scheduled values
+ */
+template <typename T>
+class TimerWheel {
+public:
+    using clock = std::chrono::steady_clock;
+
+    /** Number of slots per level */
+    static constexpr std::size_t SLOTS = 64;
+
+    /** Number of levels */
+    static constexpr std::size_t LEVELS = 4;
+
+    /**
+     * @param resolution Duration of a single tick
+     * @param start Time point of the first tick
+     */
+    explicit TimerWheel(clock::duration resolution = std::chrono::milliseconds(1), clock::time_point start = clock::now())
+      : resolution_(std::max(resolution, clock::duration(1))), start_(start), current_tick_(0), size_(0) {}
+
+    /**
+     * Remove all values and restart the wheel
+     *
+     * @param resolution Duration of a single tick
+     * @param start Time point of the first tick
+     */
+    void Reset(clock::duration resolution, clock::time_point start = clock::now()) {
+        for (auto& level : levels_) {
+            for (auto& slot : level) {
+                slot.clear();
+            }
+        }
+        resolution_ = std::max(resolution, clock::duration(1));
+        start_ = start;
+        current_tick_ = 0;
+        size_ = 0;
+    }
+
+    /** Return the duration of a single tick */
+    clock::duration Resolution() const { return resolution_; }
+
+    /** Return the number of scheduled values */
+    std::size_t Size() const { return size_; }
+
+    /** Return whether no values are scheduled */
+    bool Empty() const { return size_ == 0; }
+
+    /**
+     * Schedule a value
+     *
+     * The value expires with the first tick at or after the deadline, deadlines in the past expire with the next tick.
+     *
+     * @param value Value to schedule
+     * @param deadline Time point after which the value expires
+     */
+    void Schedule(T value, clock::time_point deadline) {
+        const auto ticks = deadline > start_ ? (deadline - start_ + resolution_ - clock::duration(1)) / resolution_ : 0;
+        Place({std::move(value), std::max(static_cast<std::uint64_t>(ticks), current_tick_ + 1)});
+        ++size_;
+    }
+
+    /**
+     * Advance the wheel and expire all values that are due
+     *
+     * @param now Current time point
+     * @param expire Function called with each expired value
+     */
+    template <typename F>
+    void Advance(clock::time_point now, F&& expire) {
+        const auto target = now > start_ ? static_cast<std::uint64_t>((now - start_) / resolution_) : 0;
+        while (current_tick_ < target) {
+            // Nothing to cascade or expire, jump ahead
+            if (size_ == 0) {
+                current_tick_ = target;
+                break;
+            }
+            ++current_tick_;
+
+            // Cascade from the highest level that wrapped around, such that values reach level zero in time
+            std::size_t wrapped = 0;
+            while (wrapped + 1 < LEVELS && (current_tick_ & ((std::uint64_t(1) << (BITS * (wrapped + 1))) - 1)) == 0) {
+                ++wrapped;
+            }
+            for (auto level = wrapped; level > 0; --level) {
+                auto entries = std::move(levels_[level][SlotIndex(current_tick_, level)]);
+                levels_[level][SlotIndex(current_tick_, level)].clear();
+                for (auto& entry : entries) {
+                    Place(std::move(entry));
+                }
+            }
+
+            // Expire level zero, the slot only holds values due at this tick
+            auto entries = std::move(levels_[0][SlotIndex(current_tick_, 0)]);
+            levels_[0][SlotIndex(current_tick_, 0)].clear();
+            size_ -= entries.size();
+            for (auto& entry : entries) {
+                expire(std::move(entry.value));
+            }
+        }
+    }
+
+private:
+    /** Scheduled value with its deadline in ticks */
+    struct Entry {
+        T value;
+        std::uint64_t tick;
+    };
+
+    /** Number of bits of the tick per level */
+    static constexpr std::size_t BITS = 6;
+
+    /** Index of the slot of a tick in a given level */
+    static std::size_t SlotIndex(std::uint64_t tick, std::size_t level) {
+        return static_cast<std::size_t>((tick >> (BITS * level)) & (SLOTS - 1));
+    }
+
+    /** Place an entry into the lowest level which can hold its deadline */
+    void Place(Entry&& entry) {
+        const auto delta = entry.tick - current_tick_;
+        for (std::size_t level = 0; level < LEVELS; ++level) {
+            if (delta < (std::uint64_t(1) << (BITS * (level + 1)))) {
+                levels_[level][SlotIndex(entry.tick, level)].push_back(std::move(entry));
+                return;
+            }
+        }
+        // Clamp to the last slot reachable from the highest level
+        entry.tick = current_tick_ + (std::uint64_t(1) << (BITS * LEVELS)) - 1;
+        levels_[LEVELS - 1][SlotIndex(entry.tick, LEVELS - 1)].push_back(std::move(entry));
+    }
+
+private:
+    clock::duration resolution_;
+    clock::time_point start_;
+    std::uint64_t current_tick_;
+    std::size_t size_;
+    std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> levels_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
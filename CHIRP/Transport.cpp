@@ -0,0 +1,28 @@
+#include "Transport.hpp"
+
+#include <utility>
+
+using namespace cnstln::CHIRP;
+
+UdpTransport::UdpTransport(asio::io_context& io_context, asio::ip::address brd_address, asio::ip::address any_address,
+                           const SocketOptions& socket_options)
+  : sender_(io_context, std::move(brd_address), socket_options),
+    receiver_(io_context, std::move(any_address), socket_options) {}
+
+void UdpTransport::Send(std::span<const AssembledMessage> messages) {
+    sender_.SendBroadcasts(messages);
+}
+
+void UdpTransport::StartReceive(AsyncRecvBatchCallback callback) {
+    receiver_.StartAsyncRecvBatch(std::move(callback));
+}
+
+void UdpTransport::StopReceive() {
+    receiver_.StopAsyncRecv();
+}
+
+MetricsSnapshot UdpTransport::GetMetricsSnapshot() const {
+    auto snapshot = sender_.GetMetrics().Snapshot();
+    snapshot += receiver_.GetMetrics().Snapshot();
+    return snapshot;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "asio.hpp"
+
+#include "CHIRP/config.hpp"
+#include "CHIRP/BroadcastRecv.hpp"
+#include "CHIRP/BroadcastSend.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/SocketOptions.hpp"
+
+namespace cnstln {
+namespace CHIRP {
+
+/**
+ * Interface for transports of CHIRP messages
+ *
+ * A transport broadcasts CHIRP messages to and receives CHIRP messages from all hosts connected to it. It can be used by
+ * a :cpp:class:`Demultiplexer` for receiving and by a :cpp:class:`Manager` for sending instead of the UDP sockets they
+ * create by default. This allows to run managers without sockets, e.g. on a :cpp:class:`MemoryBus` for simulations
+ * and tests.
+ *
+ * Sent messages are never delivered in the calling thread, such that messages can be sent while handling incoming
+ * messages.
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    /**
+     * Broadcast CHIRP messages to all hosts connected to the transport
+     *
+     * @param messages Messages to broadcast
+     */
+    virtual void Send(std::span<const AssembledMessage> messages) = 0;
+
+    /**
+     * Start receiving batches of CHIRP messages continuously
+     *
+     * Messages sent via the same transport are received as well, like broadcasts over localhost.
+     *
+     * @param callback Callback executed for every received batch of messages
+     */
+    virtual void StartReceive(AsyncRecvBatchCallback callback) = 0;
+
+    /**
+     * Stop receiving CHIRP messages
+     *
+     * After this function returns, the callback passed to :cpp:func:`StartReceive` is no longer executed. Can be called
+     * from within the callback.
+     */
+    virtual void StopReceive() = 0;
+
+    /** Get the number of incoming messages dropped by the transport, e.g. due to a full receive buffer */
+    virtual std::uint32_t GetDroppedMessages() const { return 0; }
+
+    /** Get the metrics of the transport */
+    virtual MetricsSnapshot GetMetricsSnapshot() const { return {}; }
+};
+
+/**
+ * Transport using a :cpp:class:`BroadcastSend` and a :cpp:class:`BroadcastRecv`
+ *
+ * The transport uses the same UDP sockets on :cpp:var:`CHIRP_PORT` as the managers and demultiplexers create by default.
+ * Messages are received in the threads running the IO context.
+ */
+class CHIRP_API UdpTransport : public Transport {
+public:
+    /**
+     * @param io_context IO context used for the sockets, needs to outlive the transport
+     * @param brd_address Broadcast address for outgoing messages
+     * @param any_address Any address for incoming messages
+     * @param socket_options Options for the sockets
+     */
+    UdpTransport(asio::io_context& io_context, asio::ip::address brd_address = asio::ip::address_v4::any(),
+                 asio::ip::address any_address = asio::ip::address_v4::any(),
+                 const SocketOptions& socket_options = {});
+
+    void Send(std::span<const AssembledMessage> messages) override;
+    void StartReceive(AsyncRecvBatchCallback callback) override;
+    void StopReceive() override;
+
+    std::uint32_t GetDroppedMessages() const override { return receiver_.GetDroppedMessages(); }
+
+    MetricsSnapshot GetMetricsSnapshot() const override;
+
+private:
+    BroadcastSend sender_;
+    BroadcastRecv receiver_;
+};
+
+} // namespace CHIRP
+} // namespace cnstln
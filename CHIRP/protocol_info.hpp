@@ -51,5 +51,8 @@ enum class ServiceIdentifier : std::uint8_t {
 };
 using enum ServiceIdentifier;
 
+/** Number of CHIRP service identifiers, contiguous starting at CONTROL */
+constexpr std::size_t SERVICE_IDENTIFIER_COUNT = 4;
+
 } // namespace CHIRP
 } // namespace cnstln
@@ -0,0 +1,244 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "asio.hpp"
+
+#include "CHIRP/CallbackDispatcher.hpp"
+#include "CHIRP/DiscoveredServiceTable.hpp"
+#include "CHIRP/DuplicateFilter.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/protocol_info.hpp"
+
+using namespace cnstln::CHIRP;
+using namespace std::literals::chrono_literals;
+
+namespace {
+    /**
+     * Synthetic CHIRP traffic of a number of groups with a number of hosts each
+     *
+     * Messages are drawn for random hosts and services, the message types are mixed like in a running constellation: mostly
+     * OFFERs, some REQUESTs and few DEPARTs. The traffic is deterministic for a given mix.
+     */
+    struct SyntheticTraffic {
+        SyntheticTraffic(std::size_t groups, std::size_t hosts_per_group, std::size_t count = 4096) {
+            std::mt19937 generator {groups * 1000 + hosts_per_group};
+            std::uniform_int_distribution<std::size_t> group_dist {0, groups - 1};
+            std::uniform_int_distribution<std::size_t> host_dist {0, hosts_per_group - 1};
+            std::uniform_int_distribution<std::uint8_t> service_dist {std::to_underlying(CONTROL),
+                                                                      std::to_underlying(DATA)};
+            std::uniform_int_distribution<int> type_dist {0, 99};
+            std::uniform_int_distribution<Port> port_dist {1024, 65535};
+            for (std::size_t n = 0; n < count; ++n) {
+                const auto group = "group" + std::to_string(group_dist(generator));
+                const auto host = group + "_host" + std::to_string(host_dist(generator));
+                const auto type_roll = type_dist(generator);
+                const auto type = type_roll < 80 ? OFFER : (type_roll < 95 ? REQUEST : DEPART);
+                const auto service_id = static_cast<ServiceIdentifier>(service_dist(generator));
+                const auto port = type == REQUEST ? Port(0) : port_dist(generator);
+                messages.emplace_back(type, group, host, service_id, port);
+                assembled.emplace_back(messages.back().Assemble());
+            }
+        }
+
+        std::vector<Message> messages;
+        std::vector<AssembledMessage> assembled;
+    };
+
+    /** Group and host mixes: single lab setup, few large groups, many small groups */
+    void traffic_mixes(benchmark::internal::Benchmark* benchmark) {
+        benchmark->ArgNames({"groups", "hosts"});
+        benchmark->Args({1, 8})->Args({4, 64})->Args({64, 16})->Args({16, 1024});
+    }
+
+    /** Services discovered from the OFFERs of synthetic traffic */
+    std::vector<DiscoveredService> discovered_services(const SyntheticTraffic& traffic) {
+        std::vector<DiscoveredService> services {};
+        for (const auto& message : traffic.messages) {
+            services.push_back({asio::ip::address_v4::loopback(),
+                                message.GetHostID(),
+                                message.GetServiceIdentifier(),
+                                message.GetPort()});
+        }
+        return services;
+    }
+} // namespace
+
+void benchmark_message_decode(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    std::size_t n = 0;
+    for (auto _ : state) {
+        const Message message {traffic.assembled[n++ % traffic.assembled.size()]};
+        benchmark::DoNotOptimize(message);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_message_decode)->Apply(traffic_mixes);
+
+void benchmark_message_decode_result(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    std::size_t n = 0;
+    for (auto _ : state) {
+        const auto result = Message::Decode(traffic.assembled[n++ % traffic.assembled.size()]);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_message_decode_result)->Apply(traffic_mixes);
+
+void benchmark_message_view_decode(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    std::size_t n = 0;
+    for (auto _ : state) {
+        const auto view = MessageView::Decode(traffic.assembled[n++ % traffic.assembled.size()]);
+        benchmark::DoNotOptimize(view->GetHostID());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_message_view_decode)->Apply(traffic_mixes);
+
+void benchmark_message_assemble(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    std::size_t n = 0;
+    for (auto _ : state) {
+        const auto assembled = traffic.messages[n++ % traffic.messages.size()].Assemble();
+        benchmark::DoNotOptimize(assembled);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_message_assemble)->Apply(traffic_mixes);
+
+void benchmark_message_builder(benchmark::State& state) {
+    const MessageBuilder builder {MD5Hash("group1"), MD5Hash("sat1")};
+    Port port = 0;
+    for (auto _ : state) {
+        const auto assembled = builder.Build(OFFER, DATA, port++);
+        benchmark::DoNotOptimize(assembled);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_message_builder);
+
+void benchmark_md5_hash_string(benchmark::State& state) {
+    const std::string name {"constellation_satellite_name"};
+    for (auto _ : state) {
+        const MD5Hash hash {name};
+        benchmark::DoNotOptimize(hash);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_md5_hash_string);
+
+void benchmark_md5_hash_compare(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    const auto& messages = traffic.messages;
+    std::size_t n = 0;
+    for (auto _ : state) {
+        const auto& lhs = messages[n % messages.size()];
+        const auto& rhs = messages[(n + 1) % messages.size()];
+        benchmark::DoNotOptimize(lhs.GetHostID() == rhs.GetHostID());
+        benchmark::DoNotOptimize(lhs.GetHostID() < rhs.GetHostID());
+        ++n;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_md5_hash_compare)->Apply(traffic_mixes);
+
+void benchmark_md5_hash_std_hash(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    const std::hash<MD5Hash> hasher {};
+    std::size_t n = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hasher(traffic.messages[n++ % traffic.messages.size()].GetHostID()));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_md5_hash_std_hash)->Apply(traffic_mixes);
+
+void benchmark_table_insert_erase(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    const auto services = discovered_services(traffic);
+    DiscoveredServiceTable table {};
+    for (auto _ : state) {
+        for (const auto& service : services) {
+            table.Insert(service);
+        }
+        for (const auto& service : services) {
+            table.Erase(service);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * services.size() * 2);
+}
+BENCHMARK(benchmark_table_insert_erase)->Apply(traffic_mixes);
+
+void benchmark_table_contains(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    const auto services = discovered_services(traffic);
+    DiscoveredServiceTable table {};
+    // Insert every second service such that lookups hit and miss
+    for (std::size_t n = 0; n < services.size(); n += 2) {
+        table.Insert(services[n]);
+    }
+    std::size_t n = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.Contains(services[n++ % services.size()]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_table_contains)->Apply(traffic_mixes);
+
+void benchmark_table_get(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    DiscoveredServiceTable table {};
+    for (const auto& service : discovered_services(traffic)) {
+        table.Insert(service);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(table.Get(DATA).size());
+        benchmark::DoNotOptimize(table.GetAll());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_table_get)->Apply(traffic_mixes);
+
+void benchmark_duplicate_filter(benchmark::State& state) {
+    const SyntheticTraffic traffic {static_cast<std::size_t>(state.range(0)), static_cast<std::size_t>(state.range(1))};
+    DuplicateFilter filter {10ms};
+    const auto now = std::chrono::steady_clock::now();
+    std::size_t n = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filter.IsDuplicate(traffic.assembled[n++ % traffic.assembled.size()], now));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(benchmark_duplicate_filter)->Apply(traffic_mixes);
+
+void benchmark_callback_dispatch(benchmark::State& state) {
+    constexpr std::size_t batch = 1024;
+    const auto threads = static_cast<std::size_t>(state.range(0));
+    CallbackDispatcher dispatcher {threads, SERVICE_IDENTIFIER_COUNT};
+    std::atomic_size_t executed {0};
+    std::size_t dispatched = 0;
+    for (auto _ : state) {
+        // Dispatch a burst over all service lanes and wait until it is executed
+        for (std::size_t n = 0; n < batch; ++n) {
+            dispatcher.Dispatch(n % SERVICE_IDENTIFIER_COUNT, [&]() { executed.fetch_add(1, std::memory_order_relaxed); });
+        }
+        dispatched += batch;
+        while (executed.load(std::memory_order_relaxed) < dispatched) {
+            std::this_thread::yield();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(benchmark_callback_dispatch)->ArgName("threads")->Arg(1)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <any>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "CHIRP/BroadcastSend.hpp"
+#include "CHIRP/Manager.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/protocol_info.hpp"
+#include "CHIRP/SocketOptions.hpp"
+
+using namespace cnstln::CHIRP;
+using namespace std::literals::chrono_literals;
+using clock_type = std::chrono::steady_clock;
+
+// Load generator simulating many hosts of a constellation in a single process
+//
+// The simulated hosts share one sender and broadcast pre-assembled messages in batches, the manager under test
+// receives them over loopback. Each run consists of rounds of an OFFER storm, a REQUEST storm and a DEPART storm.
+
+/** First port of the simulated services, the port encodes the index of the simulated host */
+constexpr Port BASE_PORT = 20000;
+
+/** Services offered by the simulated hosts */
+constexpr std::array<ServiceIdentifier, 4> SERVICES {CONTROL, HEARTBEAT, MONITORING, DATA};
+
+/** Discovery events observed by the manager under test */
+struct LoadState {
+    LoadState(std::size_t hosts) : send_times(hosts) {}
+
+    void Reset() {
+        offers = 0;
+        departs = 0;
+        std::lock_guard latencies_lock {latencies_mutex};
+        latencies.clear();
+    }
+
+    std::vector<std::atomic<clock_type::rep>> send_times;
+    std::atomic_size_t offers {0};
+    std::atomic_size_t departs {0};
+    std::mutex latencies_mutex;
+    std::vector<clock_type::duration> latencies;
+};
+
+void load_callback(DiscoveredService service, bool depart, std::any user_data) {
+    const auto now = clock_type::now();
+    auto* state = std::any_cast<LoadState*>(user_data);
+    const auto host = static_cast<std::size_t>(service.port - BASE_PORT);
+    if (host < state->send_times.size()) {
+        const auto sent = clock_type::time_point(clock_type::duration(state->send_times[host].load()));
+        std::lock_guard latencies_lock {state->latencies_mutex};
+        state->latencies.push_back(now - sent);
+    }
+    ++(depart ? state->departs : state->offers);
+}
+
+/** Send the message of every simulated host in batches, recording the send time per host */
+template <typename F>
+void send_storm(BroadcastSend& sender, LoadState& state, std::size_t hosts, std::size_t batch, F&& build) {
+    std::vector<AssembledMessage> messages {};
+    messages.reserve(batch * SERVICES.size());
+    for (std::size_t first = 0; first < hosts; first += batch) {
+        messages.clear();
+        const auto last = std::min(first + batch, hosts);
+        for (auto host = first; host < last; ++host) {
+            build(host, messages);
+        }
+        const auto now = clock_type::now().time_since_epoch().count();
+        for (auto host = first; host < last; ++host) {
+            state.send_times[host].store(now);
+        }
+        sender.SendBroadcasts(messages);
+    }
+}
+
+/** Wait until a counter reaches the expected value, returns false on timeout */
+bool wait_for(const std::atomic_size_t& counter, std::size_t expected, clock_type::duration timeout) {
+    const auto deadline = clock_type::now() + timeout;
+    while (counter.load() < expected) {
+        if (clock_type::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(100us);
+    }
+    return true;
+}
+
+/** Print a summary of a storm */
+void print_storm(std::string_view name, LoadState& state, std::size_t received, std::size_t expected,
+                 clock_type::duration elapsed) {
+    std::vector<clock_type::duration> latencies {};
+    {
+        std::lock_guard latencies_lock {state.latencies_mutex};
+        latencies = state.latencies;
+    }
+    std::ranges::sort(latencies);
+    const auto percentile = [&](double quantile) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        const auto index = std::min(static_cast<std::size_t>(quantile * static_cast<double>(latencies.size())),
+                                    latencies.size() - 1);
+        return std::chrono::duration<double, std::micro>(latencies[index]).count();
+    };
+    const auto loss = expected > 0 ? 100.0 * static_cast<double>(expected - std::min(received, expected)) /
+                                         static_cast<double>(expected)
+                                   : 0.0;
+    std::cout << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(1)
+              << " events " << std::setw(6) << received << "/" << std::setw(6) << expected
+              << " loss " << std::setw(5) << loss << "%"
+              << " complete " << std::setw(9) << std::chrono::duration<double, std::milli>(elapsed).count() << "ms"
+              << " latency p50 " << std::setw(8) << percentile(0.5) << "us"
+              << " p90 " << std::setw(8) << percentile(0.9) << "us"
+              << " p99 " << std::setw(8) << percentile(0.99) << "us"
+              << " max " << std::setw(8) << percentile(1.0) << "us" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Specify number of hosts, services per host, rounds, batch size and reply window via cmdline
+    std::size_t hosts = 1000;
+    std::size_t services = 1;
+    std::size_t rounds = 3;
+    std::size_t batch = 64;
+    std::size_t reply_window_ms = 0;
+    std::array<std::size_t*, 5> params {&hosts, &services, &rounds, &batch, &reply_window_ms};
+    for (int n = 1; n < argc && n <= static_cast<int>(params.size()); ++n) {
+        const std::string_view arg {argv[n]};
+        std::from_chars(arg.data(), arg.data() + arg.size(), *params[n - 1]);
+    }
+    hosts = std::clamp<std::size_t>(hosts, 1, 65535 - BASE_PORT);
+    services = std::clamp<std::size_t>(services, 1, SERVICES.size());
+    batch = std::max<std::size_t>(batch, 1);
+    // Specify broadcast and any address via cmdline, defaults to broadcasting over localhost
+    asio::ip::address brd_address = asio::ip::address_v4::any();
+    asio::ip::address any_address = asio::ip::address_v4::any();
+    if (argc >= 7) {
+        brd_address = asio::ip::make_address(argv[6]);
+    }
+    if (argc >= 8) {
+        any_address = asio::ip::make_address(argv[7]);
+    }
+
+    std::cout << "Usage: chirp_load [hosts] [services] [rounds] [batch] [reply_window_ms] [brd_address] [any_address]\n"
+              << "Simulating " << hosts << " hosts with " << services << " services, " << rounds << " rounds, batches of "
+              << batch << " hosts" << std::endl;
+
+    const std::string group {"chirp_load"};
+    SocketOptions socket_options {};
+    socket_options.receive_buffer_size = 8 * 1024 * 1024;
+    Manager manager {brd_address, any_address, group, "chirp_load_target", socket_options};
+    BroadcastSend sender {brd_address, socket_options};
+    manager.SetReplyScheduling(std::chrono::milliseconds(reply_window_ms), 0ms);
+    for (std::size_t service = 0; service < services; ++service) {
+        manager.RegisterService(SERVICES[service], BASE_PORT);
+    }
+
+    LoadState state {hosts};
+    for (std::size_t service = 0; service < services; ++service) {
+        manager.RegisterDiscoverCallback(&load_callback, SERVICES[service], &state);
+    }
+    manager.Start();
+
+    // Message builders of all simulated hosts, hashing the names only once
+    std::vector<MessageBuilder> builders {};
+    builders.reserve(hosts);
+    for (std::size_t host = 0; host < hosts; ++host) {
+        builders.emplace_back(MD5Hash(group), MD5Hash("chirp_load_host" + std::to_string(host)));
+    }
+    const auto expected = hosts * services;
+    const auto build = [&](MessageType type) {
+        return [&, type](std::size_t host, std::vector<AssembledMessage>& messages) {
+            for (std::size_t service = 0; service < services; ++service) {
+                const auto port = type == REQUEST ? Port(0) : static_cast<Port>(BASE_PORT + host);
+                messages.push_back(builders[host].Build(type, SERVICES[service], port));
+            }
+        };
+    };
+
+    for (std::size_t round = 0; round < rounds; ++round) {
+        std::cout << "Round " << round + 1 << std::endl;
+
+        // OFFER storm: time until all simulated services are discovered
+        state.Reset();
+        auto start = clock_type::now();
+        send_storm(sender, state, hosts, batch, build(OFFER));
+        wait_for(state.offers, expected, 1s);
+        print_storm("OFFER", state, state.offers.load(), expected, clock_type::now() - start);
+
+        // REQUEST storm: every simulated host requests the services of the manager under test
+        const auto before = manager.GetMetricsSnapshot();
+        start = clock_type::now();
+        send_storm(sender, state, hosts, batch, build(REQUEST));
+        std::this_thread::sleep_for(std::max(std::chrono::milliseconds(reply_window_ms), 100ms));
+        const auto after = manager.GetMetricsSnapshot();
+        if constexpr (Metrics::ENABLED) {
+            std::cout << "REQUEST  handled " << std::setw(6)
+                      << after[MetricCounter::REQUESTS_RECEIVED] - before[MetricCounter::REQUESTS_RECEIVED] << "/"
+                      << std::setw(6) << expected << " replied with "
+                      << after[MetricCounter::OFFERS_SENT] - before[MetricCounter::OFFERS_SENT] << " OFFERs"
+                      << std::endl;
+        }
+        else {
+            std::cout << "REQUEST  sent " << expected << ", build with metrics to count the replies" << std::endl;
+        }
+
+        // DEPART storm: time until all simulated services are removed
+        state.Reset();
+        start = clock_type::now();
+        send_storm(sender, state, hosts, batch, build(DEPART));
+        wait_for(state.departs, expected, 1s);
+        print_storm("DEPART", state, state.departs.load(), expected, clock_type::now() - start);
+
+        // Forget services lost in the DEPART storm for the next round
+        manager.ForgetDiscoveredServices();
+    }
+
+    std::cout << "Messages dropped by the receive socket: " << manager.GetDroppedMessages() << std::endl;
+    if constexpr (Metrics::ENABLED) {
+        const auto metrics = manager.GetMetricsSnapshot();
+        std::cout << "Datagrams received: " << metrics[MetricCounter::DATAGRAMS_RECEIVED]
+                  << ", dropped as duplicate: " << metrics[MetricCounter::DROPPED_DUPLICATE]
+                  << ", lock hold time p99: " << metrics[MetricHistogram::LOCK_HOLD_TIME].Quantile(0.99).count() << "ns"
+                  << ", callback queue delay p99: " << metrics[MetricHistogram::CALLBACK_QUEUE_DELAY].Quantile(0.99).count()
+                  << "ns" << std::endl;
+    }
+
+    return 0;
+}
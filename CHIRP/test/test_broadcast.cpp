@@ -1,13 +1,26 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <future>
+#include <span>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "asio.hpp"
 
 #include "CHIRP/BroadcastSend.hpp"
 #include "CHIRP/BroadcastRecv.hpp"
+#include "CHIRP/MemoryBus.hpp"
+#include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/Multicast.hpp"
+#include "CHIRP/NetworkInterface.hpp"
+#include "CHIRP/protocol_info.hpp"
+#include "CHIRP/SocketOptions.hpp"
+#include "CHIRP/Transport.hpp"
 
 using namespace cnstln::CHIRP;
 using namespace std::literals::chrono_literals;
@@ -87,6 +100,481 @@ int test_broadcast_async_recv_timeout() {
     return msg_opt.has_value() ? 1 : 0;
 }
 
+int test_broadcast_async_recv_external() {
+    int fails = 0;
+    // External IO context with other work, run by another thread
+    asio::io_context io_context {};
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+    BroadcastRecv receiver {io_context, "0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+
+    // Test that a received message is not reported as timeout
+    auto msg_opt_future = std::async(&BroadcastRecv::AsyncRecvBroadcast, &receiver, 100ms);
+    std::this_thread::sleep_for(5ms);
+    auto msg_content = "test message"s;
+    sender.SendBroadcast(msg_content);
+    auto msg_opt = msg_opt_future.get();
+    fails += msg_opt.has_value() && msg_opt.value().content_to_string() == msg_content ? 0 : 1;
+    // Test timeout
+    fails += receiver.AsyncRecvBroadcast(10ms).has_value() ? 1 : 0;
+    // Test that the IO context was not stopped
+    fails += io_context.stopped() ? 1 : 0;
+
+    work_guard.reset();
+    io_thread.join();
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_continuous_async_recv() {
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+
+    // Start continuous receive, promise set by first received message
+    std::promise<BroadcastMessage> msg_promise {};
+    auto msg_future = msg_promise.get_future();
+    bool msg_received = false;
+    receiver.StartAsyncRecv([&](const BroadcastMessage& message) {
+        if (!msg_received) {
+            msg_received = true;
+            msg_promise.set_value(message);
+        }
+    });
+    std::thread run_thread {&BroadcastRecv::RunAsyncRecv, &receiver};
+    // Send message
+    auto msg_content = "test message"s;
+    sender.SendBroadcast(msg_content);
+    // Receive message
+    auto msg = msg_future.get();
+    // Stop receiving, run thread should return
+    receiver.StopAsyncRecv();
+    run_thread.join();
+    // Check that message is correct
+    return msg.content_to_string() == msg_content ? 0 : 1;
+}
+
+int test_broadcast_recv_batch() {
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+
+    // Send multiple messages before receiving, including a message longer than a CHIRP message
+    auto msg_content_a = "test message a"s;
+    auto msg_content_b = "test message b"s;
+    auto msg_content_long = std::string(CHIRP_MESSAGE_LENGTH + 8, 'x');
+    sender.SendBroadcast(msg_content_a);
+    sender.SendBroadcast(msg_content_b);
+    sender.SendBroadcast(msg_content_long);
+    // Receive all messages in one batch
+    std::vector<BatchedBroadcastMessage> batch_buffer {};
+    batch_buffer.resize(8);
+    auto batch = receiver.RecvBroadcasts(batch_buffer);
+    int fails = 0;
+    if (batch.size() == 3) {
+        // Check content of messages
+        fails += std::string(batch[0].content.begin(), batch[0].content.begin() + batch[0].length) == msg_content_a ? 0 : 1;
+        fails += std::string(batch[1].content.begin(), batch[1].content.begin() + batch[1].length) == msg_content_b ? 0 : 1;
+        // Check that length of truncated message is preserved
+        fails += batch[2].length == msg_content_long.size() ? 0 : 1;
+    }
+    else {
+        fails += 1;
+    }
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_continuous_async_recv_batch() {
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+
+    // Start continuous receive, promise set by first received batch
+    std::promise<std::string> msg_promise {};
+    auto msg_future = msg_promise.get_future();
+    bool msg_received = false;
+    receiver.StartAsyncRecvBatch([&](std::span<const BatchedBroadcastMessage> messages) {
+        if (!msg_received) {
+            msg_received = true;
+            msg_promise.set_value({messages[0].content.begin(), messages[0].content.begin() + messages[0].length});
+        }
+    });
+    std::thread run_thread {&BroadcastRecv::RunAsyncRecv, &receiver};
+    // Send message
+    auto msg_content = "test message"s;
+    sender.SendBroadcast(msg_content);
+    // Receive message
+    auto msg = msg_future.get();
+    // Stop receiving, run thread should return
+    receiver.StopAsyncRecv();
+    run_thread.join();
+    // Check that message is correct
+    return msg == msg_content ? 0 : 1;
+}
+
+int test_broadcast_send_batch() {
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+
+    // Send multiple CHIRP messages in one batch
+    std::vector<AssembledMessage> asm_msgs {};
+    asm_msgs.emplace_back(Message(OFFER, "group", "host", CONTROL, 1).Assemble());
+    asm_msgs.emplace_back(Message(OFFER, "group", "host", DATA, 2).Assemble());
+    asm_msgs.emplace_back(Message(DEPART, "group", "host", DATA, 3).Assemble());
+    sender.SendBroadcasts(asm_msgs);
+    // Receive all messages
+    std::vector<BatchedBroadcastMessage> batch_buffer {};
+    batch_buffer.resize(8);
+    std::size_t received = 0;
+    int fails = 0;
+    while (received < asm_msgs.size()) {
+        for (const auto& message : receiver.RecvBroadcasts(batch_buffer)) {
+            if (received >= asm_msgs.size()) {
+                break;
+            }
+            // Check that messages arrive in order
+            fails += message.length == CHIRP_MESSAGE_LENGTH ? 0 : 1;
+            fails += std::ranges::equal(message.content, asm_msgs[received]) ? 0 : 1;
+            ++received;
+        }
+    }
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_multi_interface() {
+    int fails = 0;
+    // Test that listed interfaces are IPv4 with a broadcast address in their subnet
+    for (const auto& network_interface : GetNetworkInterfaces()) {
+        fails += network_interface.address.is_v4() && network_interface.broadcast_address.is_v4() ? 0 : 1;
+        fails += network_interface.address.is_loopback() ? 1 : 0;
+        fails += (network_interface.address.to_v4().to_uint() | network_interface.broadcast_address.to_v4().to_uint()) ==
+                         network_interface.broadcast_address.to_v4().to_uint()
+                     ? 0
+                     : 1;
+    }
+
+    // Two interfaces broadcasting over localhost, each message is received once per interface
+    BroadcastRecv receiver {"0.0.0.0"};
+    const std::vector<NetworkInterface> interfaces {{"lo1", asio::ip::address(), asio::ip::make_address("0.0.0.0")},
+                                                    {"lo2", asio::ip::address(), asio::ip::make_address("0.0.0.0")}};
+    BroadcastSend sender {interfaces};
+    std::vector<AssembledMessage> asm_msgs {};
+    asm_msgs.emplace_back(Message(OFFER, "group", "host", CONTROL, 1).Assemble());
+    asm_msgs.emplace_back(Message(OFFER, "group", "host", DATA, 2).Assemble());
+    sender.SendBroadcasts(asm_msgs);
+    std::vector<BatchedBroadcastMessage> batch_buffer {};
+    batch_buffer.resize(8);
+    std::array<std::size_t, 2> received {};
+    while (received[0] + received[1] < 2 * asm_msgs.size()) {
+        for (const auto& message : receiver.RecvBroadcasts(batch_buffer)) {
+            const auto second = std::ranges::equal(message.content, asm_msgs[1]);
+            fails += second || std::ranges::equal(message.content, asm_msgs[0]) ? 0 : 1;
+            ++received[second ? 1 : 0];
+        }
+    }
+    fails += received[0] == 2 && received[1] == 2 ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_dual_stack() {
+    int fails = 0;
+    BroadcastRecv receiver {"::"};
+    const auto asm_msg = Message(OFFER, "group", "host", CONTROL, 1).Assemble();
+    // Test that IPv4 broadcasts arrive with IPv4 sender address
+    BroadcastSend sender_v4 {"0.0.0.0"};
+    sender_v4.SendBroadcast(asm_msg.data(), asm_msg.size());
+    const auto message_v4 = receiver.AsyncRecvBroadcast(100ms);
+    fails += message_v4.has_value() && message_v4->address.is_v4() ? 0 : 1;
+    // Test that IPv6 messages arrive on the same socket
+    BroadcastSend sender_v6 {"::1"};
+    sender_v6.SendBroadcast(asm_msg.data(), asm_msg.size());
+    const auto message_v6 = receiver.AsyncRecvBroadcast(100ms);
+    fails += message_v6.has_value() && message_v6->address.is_v6() ? 0 : 1;
+    fails += message_v6.has_value() && std::ranges::equal(message_v6->content, asm_msg) ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_socket_options() {
+    int fails = 0;
+    SocketOptions socket_options {};
+    socket_options.receive_buffer_size = 1 << 16;
+    socket_options.send_buffer_size = 1 << 16;
+    socket_options.reuse_port = true;
+    socket_options.dscp = 46;
+    // Test that buffer sizes are applied, the kernel may round them up
+    asio::io_context io_context {};
+    asio::ip::udp::socket socket {io_context, asio::ip::udp::v4()};
+    socket_options.Apply(socket);
+    asio::socket_base::receive_buffer_size receive_buffer_size {};
+    socket.get_option(receive_buffer_size);
+    fails += receive_buffer_size.value() >= socket_options.receive_buffer_size ? 0 : 1;
+    asio::socket_base::send_buffer_size send_buffer_size {};
+    socket.get_option(send_buffer_size);
+    fails += send_buffer_size.value() >= socket_options.send_buffer_size ? 0 : 1;
+    // Test that messages are still sent and received with the options applied
+    BroadcastRecv receiver {"0.0.0.0", socket_options};
+    BroadcastSend sender {"0.0.0.0", socket_options};
+    const auto asm_msg = Message(OFFER, "group", "host", CONTROL, 1).Assemble();
+    sender.SendBroadcast(asm_msg.data(), asm_msg.size());
+    const auto message = receiver.AsyncRecvBroadcast(100ms);
+    fails += message.has_value() && std::ranges::equal(message->content, asm_msg) ? 0 : 1;
+    fails += receiver.GetDroppedMessages() == 0 ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_spin_recv() {
+    int fails = 0;
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+    std::promise<std::string> msg_promise {};
+    auto msg_future = msg_promise.get_future();
+    std::atomic_bool msg_received {false};
+    receiver.StartSpinRecvBatch([&](std::span<const BatchedBroadcastMessage> messages) {
+        if (!msg_received.exchange(true)) {
+            msg_promise.set_value({messages[0].content.begin(), messages[0].content.begin() + messages[0].length});
+        }
+    });
+    fails += receiver.SpinPolling() ? 0 : 1;
+    // Test that the message is received without running the IO context
+    auto msg_content = "test message"s;
+    sender.SendBroadcast(msg_content);
+    fails += msg_future.wait_for(1s) == std::future_status::ready && msg_future.get() == msg_content ? 0 : 1;
+    // Test that stopping joins the polling thread
+    receiver.StopAsyncRecv();
+    fails += receiver.SpinPolling() ? 1 : 0;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_metrics() {
+    int fails = 0;
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+    const auto asm_msg = Message(OFFER, "group", "host", CONTROL, 1).Assemble();
+    const std::array<AssembledMessage, 2> asm_msgs {asm_msg, asm_msg};
+    sender.SendBroadcasts(asm_msgs);
+    std::array<BatchedBroadcastMessage, 4> batch {};
+    std::size_t received = 0;
+    while (received < 2) {
+        received += receiver.RecvBroadcasts(batch).size();
+    }
+    // Test that sent and received messages are counted, or nothing if metrics are disabled
+    const std::uint64_t expected = Metrics::ENABLED ? 2 : 0;
+    fails += sender.GetMetrics().Snapshot()[MetricCounter::MESSAGES_SENT] == expected ? 0 : 1;
+    fails += receiver.GetMetrics().Snapshot()[MetricCounter::DATAGRAMS_RECEIVED] == expected ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_multicast() {
+    int fails = 0;
+    // Test multicast addresses are in the administratively scoped ranges and differ per group
+    const auto address_v4 = MulticastAddress(MD5Hash("group1"));
+    const auto address_v6 = MulticastAddress(MD5Hash("group1"), true);
+    fails += address_v4.is_multicast() && (address_v4.to_v4().to_uint() & 0xFFFC0000U) == 0xEFC00000U ? 0 : 1;
+    fails += address_v6.is_multicast() && address_v6.to_v6().to_bytes()[1] == 0x15 ? 0 : 1;
+    fails += MulticastAddress(MD5Hash("group2")) != address_v4 ? 0 : 1;
+
+    BroadcastRecv receiver {"0.0.0.0"};
+    if (!receiver.JoinMulticastGroup(address_v4)) {
+        // No interface with multicast support
+        return fails == 0 ? 0 : 1;
+    }
+    BroadcastSend sender {address_v4};
+    sender.SetMulticastTTL(1);
+    sender.SetMulticastLoopback(true);
+    const auto asm_msg = Message(OFFER, "group1", "host", CONTROL, 1).Assemble();
+    try {
+        sender.SendBroadcast(asm_msg.data(), asm_msg.size());
+    }
+    catch (const asio::system_error& error) {
+        // No route for multicast messages
+        return fails == 0 ? 0 : 1;
+    }
+    // Test that the multicast message is looped back to the receiver which joined the group
+    const auto message = receiver.AsyncRecvBroadcast(100ms);
+    fails += message.has_value() && std::ranges::equal(message->content, asm_msg) ? 0 : 1;
+    // Test that the group can be left again
+    fails += receiver.LeaveMulticastGroup(address_v4) ? 0 : 1;
+    fails += receiver.LeaveMulticastGroup(address_v4) ? 1 : 0;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_async_send() {
+    asio::io_context io_context {};
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {io_context, "0.0.0.0"};
+    sender.EnableAsyncSend(4, OverflowPolicy::DROP);
+
+    int fails = 0;
+    // Queue messages until the queue is full
+    const auto asm_msg = Message(OFFER, "group", "host", CONTROL, 1).Assemble();
+    for (int n = 0; n < 4; ++n) {
+        fails += sender.AsyncSendBroadcast(asm_msg) ? 0 : 1;
+    }
+    // Test that message is dropped when queue full
+    fails += sender.AsyncSendBroadcast(asm_msg) ? 1 : 0;
+    // Run IO context to drain queue
+    io_context.run();
+    // Receive all messages
+    std::vector<BatchedBroadcastMessage> batch_buffer {};
+    batch_buffer.resize(8);
+    std::size_t received = 0;
+    while (received < 4) {
+        received += receiver.RecvBroadcasts(batch_buffer).size();
+    }
+    fails += received == 4 ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_async_send_overflow_order() {
+    asio::io_context io_context {};
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {io_context, "0.0.0.0"};
+    sender.EnableAsyncSend(4, OverflowPolicy::SEND_SYNC);
+
+    int fails = 0;
+    // Overflow the queue, the overflowing message is sent synchronously
+    for (Port port = 0; port < 6; ++port) {
+        fails += sender.AsyncSendBroadcast(Message(OFFER, "group", "host", CONTROL, port).Assemble()) ? 0 : 1;
+    }
+    io_context.run();
+    // Test that messages are received in the order they were sent
+    std::vector<BatchedBroadcastMessage> batch_buffer {};
+    batch_buffer.resize(8);
+    std::vector<Port> ports {};
+    while (ports.size() < 6) {
+        for (const auto& message : receiver.RecvBroadcasts(batch_buffer)) {
+            ports.push_back(MessageView::Decode(message.content).value().GetPort());
+        }
+    }
+    fails += ports == std::vector<Port>({0, 1, 2, 3, 4, 5}) ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_group_filter() {
+    BroadcastRecv receiver {"0.0.0.0"};
+    BroadcastSend sender {"0.0.0.0"};
+
+    const auto group_a = MD5Hash("group_a");
+    const auto group_b = MD5Hash("group_b");
+    const auto group_c = MD5Hash("group_c");
+    const auto msg_a = Message(OFFER, group_a, MD5Hash("host"), DATA, 50000).Assemble();
+    const auto msg_b = Message(OFFER, group_b, MD5Hash("host"), DATA, 50001).Assemble();
+    const auto msg_c = Message(OFFER, group_c, MD5Hash("host"), DATA, 50002).Assemble();
+
+    int fails = 0;
+    const std::array<MD5Hash, 2> groups {group_a, group_c};
+    if (!receiver.AttachGroupFilter(groups)) {
+#if defined(__linux__)
+        fails += 1;
+#endif
+        return fails;
+    }
+    // Send messages of all groups and non-CHIRP message
+    sender.SendBroadcast(msg_b.data(), msg_b.size());
+    sender.SendBroadcast("test message"s);
+    sender.SendBroadcast(msg_a.data(), msg_a.size());
+    sender.SendBroadcast(msg_c.data(), msg_c.size());
+    std::this_thread::sleep_for(5ms);
+    // Test that only the messages of the filtered groups are received
+    std::vector<BatchedBroadcastMessage> batch_buffer {};
+    batch_buffer.resize(8);
+    auto batch = receiver.RecvBroadcasts(batch_buffer);
+    if (batch.size() == 2) {
+        fails += std::ranges::equal(batch[0].content, msg_a) ? 0 : 1;
+        fails += std::ranges::equal(batch[1].content, msg_c) ? 0 : 1;
+    }
+    else {
+        fails += 1;
+    }
+    // Test that detached filter accepts all messages again
+    receiver.DetachGroupFilter();
+    sender.SendBroadcast(msg_b.data(), msg_b.size());
+    batch = receiver.RecvBroadcasts(batch_buffer);
+    fails += batch.size() == 1 && std::ranges::equal(batch[0].content, msg_b) ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_memory_bus() {
+    int fails = 0;
+    MemoryBus bus {};
+    MemoryTransport transport1 {bus};
+    MemoryTransport transport2 {bus, 2};
+    fails += bus.Size() == 2 ? 0 : 1;
+    fails += transport1.GetAddress() != transport2.GetAddress() ? 0 : 1;
+    std::vector<BatchedBroadcastMessage> received1 {};
+    std::vector<BatchedBroadcastMessage> received2 {};
+    transport1.StartReceive([&](auto batch) { received1.insert(received1.end(), batch.begin(), batch.end()); });
+    transport2.StartReceive([&](auto batch) { received2.insert(received2.end(), batch.begin(), batch.end()); });
+    // Test that messages are only delivered when polling, including to the sender
+    const std::array<AssembledMessage, 3> asm_msgs {Message(OFFER, "group", "host", CONTROL, 1).Assemble(),
+                                                    Message(OFFER, "group", "host", CONTROL, 2).Assemble(),
+                                                    Message(OFFER, "group", "host", CONTROL, 3).Assemble()};
+    transport1.Send(asm_msgs);
+    fails += received1.empty() && received2.empty() ? 0 : 1;
+    fails += bus.Poll() == 5 ? 0 : 1;
+    fails += received1.size() == 3 ? 0 : 1;
+    if (received1.size() == 3) {
+        fails += std::ranges::equal(received1[2].content, asm_msgs[2]) ? 0 : 1;
+        fails += received1[2].length == CHIRP_MESSAGE_LENGTH ? 0 : 1;
+        fails += received1[2].address == asio::ip::address(transport1.GetAddress()) ? 0 : 1;
+    }
+    // Test that messages exceeding the queue capacity are dropped
+    fails += received2.size() == 2 ? 0 : 1;
+    fails += transport2.GetDroppedMessages() == 1 ? 0 : 1;
+    // Test that messages are not queued after stopping
+    transport2.StopReceive();
+    transport1.Send({asm_msgs.data(), 1});
+    fails += bus.Poll() == 1 ? 0 : 1;
+    fails += received2.size() == 2 ? 0 : 1;
+    if constexpr (Metrics::ENABLED) {
+        fails += transport1.GetMetricsSnapshot()[MetricCounter::MESSAGES_SENT] == 4 ? 0 : 1;
+        fails += transport1.GetMetricsSnapshot()[MetricCounter::DATAGRAMS_RECEIVED] == 4 ? 0 : 1;
+    }
+    // Test that the callback can stop its own transport
+    {
+        MemoryTransport transport4 {bus};
+        std::size_t received4 = 0;
+        transport4.StartReceive([&](auto batch) {
+            received4 += batch.size();
+            transport4.StopReceive();
+        });
+        transport1.Send(asm_msgs);
+        bus.Poll();
+        transport1.Send(asm_msgs);
+        bus.Poll();
+        fails += received4 == 3 ? 0 : 1;
+    }
+    // Test delivery via executor
+    asio::io_context io_context {};
+    std::atomic_size_t received3 {0};
+    {
+        MemoryTransport transport3 {bus, io_context.get_executor()};
+        transport3.StartReceive([&](auto batch) { received3 += batch.size(); });
+        transport1.Send(asm_msgs);
+        transport1.Send(asm_msgs);
+        // Only transports without executor are polled
+        fails += bus.Poll() == 6 ? 0 : 1;
+        fails += io_context.poll() == 1 ? 0 : 1;
+        fails += received3.load() == 6 ? 0 : 1;
+    }
+    fails += bus.Size() == 2 ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_broadcast_udp_transport() {
+    int fails = 0;
+    asio::io_context io_context {};
+    UdpTransport transport {io_context};
+    std::atomic_size_t received {0};
+    transport.StartReceive([&](auto batch) { received += batch.size(); });
+    const std::array<AssembledMessage, 2> asm_msgs {Message(OFFER, "group", "host", CONTROL, 1).Assemble(),
+                                                    Message(OFFER, "group", "host", CONTROL, 2).Assemble()};
+    transport.Send(asm_msgs);
+    std::this_thread::sleep_for(5ms);
+    io_context.poll();
+    transport.StopReceive();
+    io_context.poll();
+    fails += received.load() == 2 ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
 int main() {
     int ret = 0;
     int ret_test = 0;
@@ -121,6 +609,102 @@ int main() {
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_broadcast_async_recv_external
+    std::cout << "test_broadcast_async_recv_external...        " << std::flush;
+    ret_test = test_broadcast_async_recv_external();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_continuous_async_recv
+    std::cout << "test_broadcast_continuous_async_recv...      " << std::flush;
+    ret_test = test_broadcast_continuous_async_recv();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_recv_batch
+    std::cout << "test_broadcast_recv_batch...                 " << std::flush;
+    ret_test = test_broadcast_recv_batch();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_continuous_async_recv_batch
+    std::cout << "test_broadcast_continuous_async_recv_batch..." << std::flush;
+    ret_test = test_broadcast_continuous_async_recv_batch();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_send_batch
+    std::cout << "test_broadcast_send_batch...                 " << std::flush;
+    ret_test = test_broadcast_send_batch();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_multi_interface
+    std::cout << "test_broadcast_multi_interface...            " << std::flush;
+    ret_test = test_broadcast_multi_interface();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_dual_stack
+    std::cout << "test_broadcast_dual_stack...                 " << std::flush;
+    ret_test = test_broadcast_dual_stack();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_socket_options
+    std::cout << "test_broadcast_socket_options...             " << std::flush;
+    ret_test = test_broadcast_socket_options();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_spin_recv
+    std::cout << "test_broadcast_spin_recv...                  " << std::flush;
+    ret_test = test_broadcast_spin_recv();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_metrics
+    std::cout << "test_broadcast_metrics...                    " << std::flush;
+    ret_test = test_broadcast_metrics();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_multicast
+    std::cout << "test_broadcast_multicast...                  " << std::flush;
+    ret_test = test_broadcast_multicast();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_async_send
+    std::cout << "test_broadcast_async_send...                 " << std::flush;
+    ret_test = test_broadcast_async_send();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_async_send_overflow_order
+    std::cout << "test_broadcast_async_send_overflow_order...  " << std::flush;
+    ret_test = test_broadcast_async_send_overflow_order();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_group_filter
+    std::cout << "test_broadcast_group_filter...               " << std::flush;
+    ret_test = test_broadcast_group_filter();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_memory_bus
+    std::cout << "test_broadcast_memory_bus...                 " << std::flush;
+    ret_test = test_broadcast_memory_bus();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_broadcast_udp_transport
+    std::cout << "test_broadcast_udp_transport...              " << std::flush;
+    ret_test = test_broadcast_udp_transport();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     if (ret == 0) {
         std::cout << "\nAll tests passed" << std::endl;
     }
@@ -1,16 +1,36 @@
+#include <algorithm>
 #include <any>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <future>
+#include <random>
+#include <set>
+#include <span>
+#include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include "asio.hpp"
 
 #include "CHIRP/BroadcastRecv.hpp"
 #include "CHIRP/BroadcastSend.hpp"
+#include "CHIRP/CallbackDispatcher.hpp"
+#include "CHIRP/Demultiplexer.hpp"
+#include "CHIRP/DiscoveredServiceTable.hpp"
+#include "CHIRP/DiscoveryCache.hpp"
+#include "CHIRP/DuplicateFilter.hpp"
 #include "CHIRP/Manager.hpp"
+#include "CHIRP/MemoryBus.hpp"
 #include "CHIRP/Message.hpp"
+#include "CHIRP/Metrics.hpp"
+#include "CHIRP/SocketOptions.hpp"
+#include "CHIRP/TimerWheel.hpp"
 
 using namespace cnstln::CHIRP;
 using namespace std::literals::chrono_literals;
@@ -49,6 +69,54 @@ int test_manager_sort_discovered_service() {
     return fails == 0 ? 0 : 1;
 }
 
+int test_manager_discovered_service_table() {
+    int fails = 0;
+    DiscoveredServiceTable table {};
+    std::set<DiscoveredService> reference {};
+    std::mt19937 generator {42};
+    std::uniform_int_distribution<int> host_dist {0, 63};
+    std::uniform_int_distribution<int> id_dist {1, 4};
+    std::uniform_int_distribution<int> port_dist {50000, 50003};
+    // Random inserts and erases, compared against std::set
+    for (int n = 0; n < 20000; ++n) {
+        const DiscoveredService service {asio::ip::make_address("127.0.0.1"),
+                                         MD5Hash("host" + std::to_string(host_dist(generator))),
+                                         static_cast<ServiceIdentifier>(id_dist(generator)),
+                                         static_cast<Port>(port_dist(generator))};
+        if (n % 3 == 0) {
+            fails += table.Erase(service) == (reference.erase(service) > 0) ? 0 : 1;
+        }
+        else {
+            fails += table.Insert(service) == reference.insert(service).second ? 0 : 1;
+        }
+        fails += table.Size() == reference.size() ? 0 : 1;
+    }
+    // Test that every service is found in the table and in the right list
+    for (const auto& service : reference) {
+        fails += table.Contains(service) ? 0 : 1;
+        fails += std::ranges::count_if(table.Get(service.identifier), [&](const auto& entry) {
+                     return !(entry < service) && !(service < entry);
+                 }) == 1 ? 0 : 1;
+    }
+    // Test that all services are ordered by service identifier
+    const auto all = table.GetAll();
+    fails += all.size() == reference.size() ? 0 : 1;
+    fails += std::ranges::is_sorted(all, {}, &DiscoveredService::identifier) ? 0 : 1;
+    // Test that address is not part of the key
+    if (!all.empty()) {
+        auto service = all.front();
+        service.address = asio::ip::make_address("127.0.0.2");
+        fails += table.Contains(service) ? 0 : 1;
+        fails += table.Insert(service) ? 1 : 0;
+    }
+    // Test clear
+    table.Clear();
+    fails += table.Empty() ? 0 : 1;
+    fails += table.Get(DATA).empty() ? 0 : 1;
+    fails += reference.empty() || !table.Contains(*reference.begin()) ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
 int test_manager_sort_discover_callback_entry() {
     auto* cb1 = reinterpret_cast<DiscoverCallback*>(1);
     auto* cb2 = reinterpret_cast<DiscoverCallback*>(2);
@@ -206,6 +274,35 @@ int test_manager_discovery() {
     return fails == 0 ? 0 : 1;
 }
 
+int test_manager_discovery_snapshot() {
+    Manager manager1 {"0.0.0.0", "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {"0.0.0.0", "0.0.0.0", "group1", "sat2"};
+    manager2.Start();
+
+    int fails = 0;
+    // Test that initial snapshot is empty
+    const auto snapshot_0 = manager2.GetDiscoveredServicesSnapshot();
+    fails += snapshot_0 != nullptr && snapshot_0->empty() ? 0 : 1;
+    // Register service
+    manager1.RegisterService(DATA, 24000);
+    std::this_thread::sleep_for(5ms);
+    const auto snapshot_1 = manager2.GetDiscoveredServicesSnapshot();
+    fails += snapshot_1->size() == 1 ? 0 : 1;
+    // Test that old snapshot is unchanged
+    fails += snapshot_0->empty() ? 0 : 1;
+    // Test that snapshot is not republished without changes
+    manager1.SendRequest(CONTROL);
+    std::this_thread::sleep_for(5ms);
+    fails += manager2.GetDiscoveredServicesSnapshot() == snapshot_1 ? 0 : 1;
+    // Unregister service
+    manager1.UnregisterService(DATA, 24000);
+    std::this_thread::sleep_for(5ms);
+    fails += manager2.GetDiscoveredServicesSnapshot()->empty() ? 0 : 1;
+    fails += snapshot_1->size() == 1 ? 0 : 1;
+
+    return fails == 0 ? 0 : 1;
+}
+
 int test_manager_callbacks() {
     Manager manager1 {"0.0.0.0", "0.0.0.0", "group1", "sat1"};
     Manager manager2 {"0.0.0.0", "0.0.0.0", "group1", "sat2"};
@@ -270,6 +367,92 @@ int test_manager_callbacks() {
     return fails == 0 ? 0 : 1;
 }
 
+int test_manager_callback_index() {
+    Manager manager1 {"0.0.0.0", "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {"0.0.0.0", "0.0.0.0", "group1", "sat2"};
+    manager2.Start();
+
+    // Count callbacks per registration
+    std::atomic_int data_count {0};
+    std::atomic_int control_count {0};
+    auto callback = [](DiscoveredService /*service*/, bool /*depart*/, std::any cb_info) {
+        std::any_cast<std::atomic_int*>(cb_info)->fetch_add(1);
+    };
+
+    int fails = 0;
+    // Test that the same callback can be registered once per service identifier
+    fails += manager2.RegisterDiscoverCallback(callback, DATA, &data_count) ? 0 : 1;
+    fails += manager2.RegisterDiscoverCallback(callback, CONTROL, &control_count) ? 0 : 1;
+    fails += manager2.RegisterDiscoverCallback(callback, DATA, &control_count) ? 1 : 0;
+    // Test that only the callback of the service identifier is dispatched
+    manager1.RegisterService(DATA, 50100);
+    std::this_thread::sleep_for(5ms);
+    fails += data_count == 1 ? 0 : 1;
+    fails += control_count == 0 ? 0 : 1;
+    // Test that unregistering only affects the given service identifier
+    fails += manager2.UnregisterDiscoverCallback(callback, HEARTBEAT) ? 1 : 0;
+    fails += manager2.UnregisterDiscoverCallback(callback, DATA) ? 0 : 1;
+    manager1.RegisterService(DATA, 50101);
+    manager1.RegisterService(CONTROL, 50102);
+    std::this_thread::sleep_for(5ms);
+    fails += data_count == 1 ? 0 : 1;
+    fails += control_count == 1 ? 0 : 1;
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_batch_callbacks() {
+    Manager manager1 {"0.0.0.0", "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {"0.0.0.0", "0.0.0.0", "group1", "sat2"};
+    manager2.SetDiscoverBatchWindow(50ms);
+    manager2.Start();
+
+    // Collect batches, use pointer to access test variable
+    std::vector<std::vector<DiscoveryEvent>> batches {};
+    auto callback = [](std::span<const DiscoveryEvent> events, void* user_data) {
+        auto* batches_l = static_cast<std::vector<std::vector<DiscoveryEvent>>*>(user_data);
+        batches_l->emplace_back(events.begin(), events.end());
+    };
+
+    int fails = 0;
+    // Register batch callback for DATA
+    manager2.RegisterDiscoverBatchCallback(callback, DATA, &batches);
+    // Register burst of DATA services and a CONTROL service
+    for (Port port = 50100; port < 50110; ++port) {
+        manager1.RegisterService(DATA, port);
+    }
+    manager1.RegisterService(CONTROL, 50200);
+    // Wait until the coalescing window expired
+    std::this_thread::sleep_for(100ms);
+    // Test that the burst arrived in a single batch without the CONTROL service
+    fails += batches.size() == 1 ? 0 : 1;
+    if (batches.size() == 1) {
+        fails += batches[0].size() == 10 ? 0 : 1;
+        fails += std::ranges::all_of(batches[0], [](const auto& event) { return !event.depart && event.service.identifier == DATA; }) ? 0 : 1;
+        fails += batches[0].front().service.port == 50100 ? 0 : 1;
+    }
+
+    // Unregister all services
+    manager1.UnregisterServices();
+    std::this_thread::sleep_for(100ms);
+    // Test that the DEPARTs arrived in a single batch
+    fails += batches.size() == 2 ? 0 : 1;
+    if (batches.size() == 2) {
+        fails += batches[1].size() == 10 ? 0 : 1;
+        fails += std::ranges::all_of(batches[1], [](const auto& event) { return event.depart; }) ? 0 : 1;
+    }
+
+    // Unregister callback
+    fails += manager2.UnregisterDiscoverBatchCallback(callback, DATA) ? 0 : 1;
+    fails += manager2.UnregisterDiscoverBatchCallback(callback, DATA) ? 1 : 0;
+    manager1.RegisterService(DATA, 50100);
+    std::this_thread::sleep_for(100ms);
+    // Test that we did not get another batch
+    fails += batches.size() == 2 ? 0 : 1;
+
+    return fails == 0 ? 0 : 1;
+}
+
 int test_manager_send_request() {
     Manager manager {"0.0.0.0", "0.0.0.0", "group1", "sat1"};
     BroadcastRecv receiver {"0.0.0.0"};
@@ -311,6 +494,133 @@ int test_manager_recv_request() {
     return 0;
 }
 
+int test_manager_offer_replay() {
+    // Share receive socket such that both managers receive each others messages
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    manager1.RegisterService(DATA, 50001);
+    manager1.RegisterService(DATA, 50002);
+    manager1.RegisterService(DATA, 50003);
+    manager1.RegisterService(CONTROL, 50004);
+    fails += manager1.UnregisterService(DATA, 50002) ? 0 : 1;
+    fails += manager1.UnregisterService(DATA, 50002) ? 1 : 0;
+    std::this_thread::sleep_for(5ms);
+    // Test that REQUEST is replied with the remaining pre-assembled OFFERs
+    manager2.ForgetDiscoveredServices();
+    manager2.SendRequest(DATA);
+    std::this_thread::sleep_for(5ms);
+    auto services = manager2.GetDiscoveredServices(DATA);
+    std::ranges::sort(services, {}, &DiscoveredService::port);
+    fails += services.size() == 2 ? 0 : 1;
+    if (services.size() == 2) {
+        fails += services[0].port == 50001 ? 0 : 1;
+        fails += services[1].port == 50003 ? 0 : 1;
+    }
+    fails += manager2.GetDiscoveredServices(CONTROL).empty() ? 0 : 1;
+    // Test that DEPARTs are sent for all services
+    manager2.SendRequest(CONTROL);
+    std::this_thread::sleep_for(5ms);
+    fails += manager2.GetDiscoveredServices().size() == 3 ? 0 : 1;
+    manager1.UnregisterServices();
+    std::this_thread::sleep_for(5ms);
+    fails += manager2.GetDiscoveredServices().empty() ? 0 : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_reply_scheduling() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    manager1.SetReplyScheduling(50ms, 10ms);
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    manager1.RegisterService(DATA, 50001);
+    std::this_thread::sleep_for(5ms);
+    // Test that REQUEST within the window after the OFFER on registration is not replied
+    manager2.ForgetDiscoveredServices();
+    manager2.SendRequest(DATA);
+    std::this_thread::sleep_for(20ms);
+    fails += manager2.GetDiscoveredServices().empty() ? 0 : 1;
+    // Test that REQUEST is replied after the jitter
+    std::this_thread::sleep_for(40ms);
+    manager2.ForgetDiscoveredServices();
+    manager2.SendRequest(DATA);
+    std::this_thread::sleep_for(20ms);
+    fails += manager2.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    // Test that REQUEST within the window is not replied
+    manager2.ForgetDiscoveredServices();
+    manager2.SendRequest(DATA);
+    std::this_thread::sleep_for(5ms);
+    fails += manager2.GetDiscoveredServices().empty() ? 0 : 1;
+    // Test that REQUEST after the window is replied, and that multiple REQUESTs are coalesced
+    std::this_thread::sleep_for(60ms);
+    manager2.ForgetDiscoveredServices();
+    manager2.SendRequest(DATA);
+    manager2.SendRequest(DATA);
+    manager2.SendRequest(DATA);
+    std::this_thread::sleep_for(20ms);
+    fails += manager2.GetDiscoveredServices().size() == 1 ? 0 : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_reply_after_announcement() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    manager1.SetReplyScheduling(80ms, 1ms);
+    manager1.SetAnnounceInterval(100ms);
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    manager1.RegisterService(DATA, 50001);
+    // Test that REQUEST within the window after an announcement is not replied, the registration is outside the window
+    std::this_thread::sleep_for(120ms);
+    fails += manager2.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    manager2.ForgetDiscoveredServices();
+    manager2.SendRequest(DATA);
+    std::this_thread::sleep_for(20ms);
+    fails += manager2.GetDiscoveredServices().empty() ? 0 : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
 int test_manager_decode_error() {
     BroadcastSend sender {"0.0.0.0"};
     Manager manager {"0.0.0.0", "0.0.0.0", "group1", "sat1"};
@@ -328,6 +638,813 @@ int test_manager_decode_error() {
     return 0;
 }
 
+int test_manager_shared_io_context() {
+    asio::io_context io_context {};
+    Manager manager1 {io_context, "0.0.0.0", "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {io_context, "0.0.0.0", "0.0.0.0", "group1", "sat2"};
+    manager2.Start();
+
+    // Run IO context for both managers from a single thread
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    // Register service, should send OFFER
+    manager1.RegisterService(DATA, 24000);
+    // Wait a bit ensure we received the message
+    std::this_thread::sleep_for(5ms);
+    // Test that we discovered the service
+    fails += manager2.GetDiscoveredServices().size() == 1 ? 0 : 1;
+
+    // Stop IO context
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_shared_demultiplexer() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group2", "sat2"};
+    Manager manager3 {demultiplexer, "0.0.0.0", "group1", "sat3"};
+    manager1.Start();
+    manager2.Start();
+    manager3.Start();
+    demultiplexer.Start();
+
+    // Run IO context for all managers from a single thread
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    // Register service, should send OFFER
+    manager3.RegisterService(DATA, 24000);
+    // Wait a bit ensure we received the message
+    std::this_thread::sleep_for(5ms);
+    // Test that only the manager in the same group discovered the service
+    fails += manager1.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    fails += manager2.GetDiscoveredServices().size() == 0 ? 0 : 1;
+    // Test that the sending manager ignored its own message
+    fails += manager3.GetDiscoveredServices().size() == 0 ? 0 : 1;
+
+    // Stop IO context
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_kernel_filter() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    const auto kernel_filter = demultiplexer.EnableKernelFilter();
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group2", "sat2"};
+    BroadcastSend sender {"0.0.0.0"};
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+#if defined(__linux__)
+    fails += kernel_filter ? 0 : 1;
+#endif
+    // Send OFFERs from a foreign group, from self and from another host
+    const auto asm_msg_foreign = Message(OFFER, "group3", "sat3", CONTROL, 23999).Assemble();
+    const auto asm_msg_self = Message(OFFER, "group1", "sat1", CONTROL, 24000).Assemble();
+    const auto asm_msg_other = Message(OFFER, "group2", "sat3", CONTROL, 24001).Assemble();
+    sender.SendBroadcast(asm_msg_foreign.data(), asm_msg_foreign.size());
+    sender.SendBroadcast(asm_msg_self.data(), asm_msg_self.size());
+    sender.SendBroadcast(asm_msg_other.data(), asm_msg_other.size());
+    std::this_thread::sleep_for(5ms);
+    // Test that only the OFFER from another host of a registered group is discovered
+    fails += manager1.GetDiscoveredServices().empty() ? 0 : 1;
+    fails += manager2.GetDiscoveredServices().size() == 1 ? 0 : 1;
+
+    // Test that the filter follows the registered groups
+    demultiplexer.UnregisterManager(&manager2);
+    manager2.ForgetDiscoveredServices();
+    sender.SendBroadcast(asm_msg_other.data(), asm_msg_other.size());
+    std::this_thread::sleep_for(5ms);
+    fails += manager2.GetDiscoveredServices().empty() ? 0 : 1;
+    demultiplexer.RegisterManager(&manager2);
+    sender.SendBroadcast(asm_msg_other.data(), asm_msg_other.size());
+    std::this_thread::sleep_for(5ms);
+    fails += manager2.GetDiscoveredServices().size() == 1 ? 0 : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_dual_stack() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "::"};
+    Manager manager {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    BroadcastSend sender_v4 {"0.0.0.0"};
+    BroadcastSend sender_v6 {"::1"};
+    manager.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    // Send OFFERs via IPv4 and IPv6
+    const auto asm_msg_v4 = Message(OFFER, "group1", "sat2", CONTROL, 23999).Assemble();
+    const auto asm_msg_v6 = Message(OFFER, "group1", "sat3", CONTROL, 24000).Assemble();
+    sender_v4.SendBroadcast(asm_msg_v4.data(), asm_msg_v4.size());
+    sender_v6.SendBroadcast(asm_msg_v6.data(), asm_msg_v6.size());
+    std::this_thread::sleep_for(5ms);
+    // Test that both services are in the same table with the address of their family
+    const auto services = manager.GetDiscoveredServices();
+    fails += services.size() == 2 ? 0 : 1;
+    for (const auto& service : services) {
+        fails += service.address.is_v4() == (service.host_id == MD5Hash("sat2")) ? 0 : 1;
+    }
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_spin_poll() {
+    SocketOptions socket_options {};
+    socket_options.receive_buffer_size = 1 << 20;
+    socket_options.spin_poll = true;
+    Manager manager {"0.0.0.0", "0.0.0.0", "group1", "sat1", socket_options};
+    BroadcastSend sender {"0.0.0.0"};
+    manager.Start();
+
+    int fails = 0;
+    // Test that services are discovered via the polling thread
+    const auto asm_msg = Message(OFFER, "group1", "sat2", CONTROL, 23999).Assemble();
+    sender.SendBroadcast(asm_msg.data(), asm_msg.size());
+    std::this_thread::sleep_for(5ms);
+    fails += manager.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    fails += manager.GetDroppedMessages() == 0 ? 0 : 1;
+
+    // Destructor needs to stop the polling thread and the run loop
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_multicast() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {MULTICAST, demultiplexer, false, "group1", "sat1"};
+    Manager manager2 {MULTICAST, demultiplexer, false, "group1", "sat2"};
+    manager1.Start();
+    manager2.Start();
+    if (!demultiplexer.EnableMulticast()) {
+        // No interface with multicast support
+        return 0;
+    }
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    try {
+        // Test that the OFFER sent via multicast is discovered by the other manager of the group
+        manager1.RegisterService(CONTROL, 23999);
+        std::this_thread::sleep_for(10ms);
+        fails += manager2.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    }
+    catch (const asio::system_error& error) {
+        // No route for multicast messages
+    }
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_duplicate_filter() {
+    int fails = 0;
+    DuplicateFilter filter {10ms, 16};
+    const auto asm_offer = Message(OFFER, "group1", "sat1", CONTROL, 23999).Assemble();
+    const auto asm_depart = Message(DEPART, "group1", "sat1", CONTROL, 23999).Assemble();
+    const auto start = std::chrono::steady_clock::now();
+    // Test identical messages within the window are duplicates, different messages are not
+    fails += filter.IsDuplicate(asm_offer, start) ? 1 : 0;
+    fails += filter.IsDuplicate(asm_offer, start + 1ms) ? 0 : 1;
+    fails += filter.IsDuplicate(asm_depart, start + 1ms) ? 1 : 0;
+    // Test duplicates do not extend the window
+    fails += filter.IsDuplicate(asm_offer, start + 9ms) ? 0 : 1;
+    fails += filter.IsDuplicate(asm_offer, start + 11ms) ? 1 : 0;
+    fails += DuplicateFilter::Hash(asm_offer) != DuplicateFilter::Hash(asm_depart) ? 0 : 1;
+    // Test repeats after another message type are not duplicates when keyed without the type
+    DuplicateFilter type_filter {10ms, 16};
+    fails += type_filter.IsDuplicate(asm_offer, MessageLayout::TYPE_OFFSET, start) ? 1 : 0;
+    fails += type_filter.IsDuplicate(asm_offer, MessageLayout::TYPE_OFFSET, start + 1ms) ? 0 : 1;
+    fails += type_filter.IsDuplicate(asm_depart, MessageLayout::TYPE_OFFSET, start + 2ms) ? 1 : 0;
+    fails += type_filter.IsDuplicate(asm_depart, MessageLayout::TYPE_OFFSET, start + 3ms) ? 0 : 1;
+    fails += type_filter.IsDuplicate(asm_offer, MessageLayout::TYPE_OFFSET, start + 4ms) ? 1 : 0;
+
+    // Test duplicates are discarded by the demultiplexer while later broadcasts pass
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    demultiplexer.EnableDuplicateFilter(2ms);
+    Manager manager {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    BroadcastSend sender {"0.0.0.0"};
+    std::atomic_int offers {0};
+    auto callback = [](DiscoveredService, bool depart, std::any user_data) {
+        if (!depart) {
+            ++*std::any_cast<std::atomic_int*>(user_data);
+        }
+    };
+    manager.RegisterDiscoverCallback(callback, CONTROL, &offers);
+    manager.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    sender.SendBroadcast(asm_offer.data(), asm_offer.size());
+    sender.SendBroadcast(asm_offer.data(), asm_offer.size());
+    std::this_thread::sleep_for(5ms);
+    fails += manager.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    sender.SendBroadcast(asm_depart.data(), asm_depart.size());
+    std::this_thread::sleep_for(5ms);
+    fails += manager.GetDiscoveredServices().empty() ? 0 : 1;
+    sender.SendBroadcast(asm_offer.data(), asm_offer.size());
+    std::this_thread::sleep_for(5ms);
+    fails += manager.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    fails += offers.load() == 2 ? 0 : 1;
+    // Test a departure and a new offer within the window both pass
+    sender.SendBroadcast(asm_depart.data(), asm_depart.size());
+    sender.SendBroadcast(asm_offer.data(), asm_offer.size());
+    std::this_thread::sleep_for(5ms);
+    fails += manager.GetDiscoveredServices().size() == 1 ? 0 : 1;
+    fails += offers.load() == 3 ? 0 : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_timer_wheel() {
+    int fails = 0;
+    const auto start = std::chrono::steady_clock::now();
+    TimerWheel<int> wheel {1ms, start};
+    std::vector<int> expired {};
+    const auto collect = [&](int value) { expired.push_back(value); };
+    // Schedule values in different levels, including one beyond the range of the wheel
+    wheel.Schedule(1, start + 5ms);
+    wheel.Schedule(2, start + 100ms);
+    wheel.Schedule(3, start + 5000ms);
+    wheel.Schedule(4, start + 300000ms);
+    wheel.Schedule(5, start + std::chrono::hours(24 * 365));
+    fails += wheel.Size() == 5 ? 0 : 1;
+    // Test values expire at their deadline and not before
+    wheel.Advance(start + 4ms, collect);
+    fails += expired.empty() ? 0 : 1;
+    wheel.Advance(start + 5ms, collect);
+    fails += expired == std::vector<int>({1}) ? 0 : 1;
+    wheel.Advance(start + 99ms, collect);
+    fails += expired.size() == 1 ? 0 : 1;
+    wheel.Advance(start + 100ms, collect);
+    wheel.Advance(start + 4999ms, collect);
+    fails += expired == std::vector<int>({1, 2}) ? 0 : 1;
+    wheel.Advance(start + 5000ms, collect);
+    wheel.Advance(start + 300000ms, collect);
+    fails += expired == std::vector<int>({1, 2, 3, 4}) ? 0 : 1;
+    fails += wheel.Size() == 1 ? 0 : 1;
+    // Test deadlines in the past expire with the next tick
+    wheel.Schedule(6, start);
+    wheel.Advance(start + 300001ms, collect);
+    fails += expired.back() == 6 ? 0 : 1;
+    // Test reset drops all values
+    wheel.Reset(1ms, start);
+    fails += wheel.Empty() ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_liveness() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    BroadcastSend sender {"0.0.0.0"};
+    manager1.SetDiscoveryTTL(80ms);
+    manager2.SetAnnounceInterval(10ms);
+
+    std::atomic_int departs {0};
+    auto callback = [](DiscoveredService service, bool depart, std::any user_data) {
+        if (depart && service.host_id == MD5Hash("sat3")) {
+            ++*std::any_cast<std::atomic_int*>(user_data);
+        }
+    };
+    manager1.RegisterDiscoverCallback(callback, CONTROL, &departs);
+
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    // Announced service and a single OFFER from a host which crashes afterwards
+    manager2.RegisterService(CONTROL, 23999);
+    const auto asm_msg = Message(OFFER, "group1", "sat3", CONTROL, 24000).Assemble();
+    sender.SendBroadcast(asm_msg.data(), asm_msg.size());
+    std::this_thread::sleep_for(20ms);
+    fails += manager1.GetDiscoveredServices().size() == 2 ? 0 : 1;
+    // Test that the crashed host expired with a DEPART callback, while the announced service stays
+    std::this_thread::sleep_for(200ms);
+    const auto services = manager1.GetDiscoveredServices();
+    fails += services.size() == 1 ? 0 : 1;
+    fails += !services.empty() && services.front().host_id == MD5Hash("sat2") ? 0 : 1;
+    fails += departs.load() == 1 ? 0 : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_idle_expiry() {
+    int fails = 0;
+    asio::io_context io_context {};
+    MemoryBus bus {};
+    MemoryTransport transport1 {bus};
+    MemoryTransport transport2 {bus};
+    Manager manager1 {io_context, transport1, "group1", "sat1"};
+    Manager manager2 {io_context, transport2, "group1", "sat2"};
+    manager1.SetDiscoveryTTL(20ms);
+    manager1.Start();
+    manager2.Start();
+    // Test that the expiry timer is not armed without discovered services, such that the IO context runs out of work
+    io_context.run_for(10ms);
+    fails += io_context.stopped() ? 0 : 1;
+    // Test that discovering a service arms the expiry timer until the service expired
+    manager2.RegisterService(CONTROL, 23999);
+    bus.Poll();
+    io_context.restart();
+    io_context.run_for(10ms);
+    fails += manager1.GetDiscoveredServices().size() == 1 && !io_context.stopped() ? 0 : 1;
+    io_context.run_for(100ms);
+    fails += manager1.GetDiscoveredServices().empty() && io_context.stopped() ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_async_discover() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    int fails = 0;
+    // Test that a pending discovery completes with the OFFER
+    std::promise<std::pair<asio::error_code, DiscoveredService>> discover_promise {};
+    auto discover_future = discover_promise.get_future();
+    manager1.AsyncDiscover(DATA, 1s, [&](asio::error_code ec, DiscoveredService service) {
+        discover_promise.set_value({ec, service});
+    });
+    auto subscription = manager1.SubscribeDiscovery(DATA);
+    manager2.RegisterService(DATA, 24000);
+    if (discover_future.wait_for(1s) == std::future_status::ready) {
+        const auto [ec, service] = discover_future.get();
+        fails += !ec && service.port == 24000 && service.host_id == MD5Hash("sat2") ? 0 : 1;
+    }
+    else {
+        fails += 1;
+    }
+    // Test that an already discovered service completes immediately
+    auto discovered_future = manager1.AsyncDiscover(DATA, 1s, asio::use_future);
+    fails += discovered_future.wait_for(100ms) == std::future_status::ready && discovered_future.get().port == 24000 ? 0 : 1;
+    // Test that the timeout is reported as error
+    auto timeout_future = manager1.AsyncDiscover(HEARTBEAT, 10ms, asio::use_future);
+    try {
+        timeout_future.get();
+        fails += 1;
+    } catch (const asio::system_error& error) {
+        fails += error.code() == asio::error::timed_out ? 0 : 1;
+    }
+    // Test that the subscription queued the OFFER and the DEPART
+    manager2.UnregisterService(DATA, 24000);
+    auto offer_future = subscription.AsyncNext(asio::use_future);
+    auto depart_future = subscription.AsyncNext(asio::use_future);
+    fails += offer_future.wait_for(1s) == std::future_status::ready && !offer_future.get().depart ? 0 : 1;
+    fails += depart_future.wait_for(1s) == std::future_status::ready && depart_future.get().depart ? 0 : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+#if defined(ASIO_HAS_CO_AWAIT)
+int test_manager_co_await_discover() {
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    // Coroutine waiting for the service, then for its departure
+    auto subscription = manager1.SubscribeDiscovery(DATA);
+    auto coroutine = [&]() -> asio::awaitable<int> {
+        int fails = 0;
+        const auto service = co_await manager1.AsyncDiscover(DATA, 1s, asio::use_awaitable);
+        fails += service.port == 24000 ? 0 : 1;
+        const auto offer = co_await subscription.AsyncNext(asio::use_awaitable);
+        fails += !offer.depart && offer.service.port == 24000 ? 0 : 1;
+        const auto depart = co_await subscription.AsyncNext(asio::use_awaitable);
+        fails += depart.depart ? 0 : 1;
+        co_return fails;
+    };
+    auto coroutine_future = asio::co_spawn(io_context, coroutine(), asio::use_future);
+    manager2.RegisterService(DATA, 24000);
+    std::this_thread::sleep_for(5ms);
+    manager2.UnregisterService(DATA, 24000);
+    const auto fails = coroutine_future.wait_for(1s) == std::future_status::ready ? coroutine_future.get() : 1;
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+#endif
+
+int test_manager_metrics() {
+    int fails = 0;
+    // Test histogram quantiles and export
+    Metrics metrics {};
+    for (int n = 0; n < 99; ++n) {
+        metrics.Record(MetricHistogram::DECODE_TIME, 100ns);
+    }
+    metrics.Record(MetricHistogram::DECODE_TIME, 1ms);
+    metrics.Increment(MetricCounter::OFFERS_SENT, 3);
+    const auto snapshot = metrics.Snapshot();
+    const auto& decode_time = snapshot[MetricHistogram::DECODE_TIME];
+    const auto prometheus = snapshot.ToPrometheus();
+    if constexpr (Metrics::ENABLED) {
+        fails += snapshot[MetricCounter::OFFERS_SENT] == 3 ? 0 : 1;
+        fails += decode_time.count == 100 && decode_time.sum == 99 * 100 + 1000000 ? 0 : 1;
+        // Buckets are powers of two
+        fails += decode_time.Quantile(0.5) == 128ns ? 0 : 1;
+        fails += decode_time.Quantile(1.0) == 1048576ns ? 0 : 1;
+        fails += prometheus.find("chirp_offers_sent_total 3\n") != std::string::npos ? 0 : 1;
+        fails += prometheus.find("chirp_decode_time_seconds_count 100\n") != std::string::npos ? 0 : 1;
+        const auto bucket_128ns = "chirp_decode_time_seconds_bucket{le=\"0.000000128\"} 99\n";
+        fails += prometheus.find(bucket_128ns) != std::string::npos ? 0 : 1;
+        fails += prometheus.find("chirp_decode_time_seconds_sum 0.0010099\n") != std::string::npos ? 0 : 1;
+    }
+    else {
+        fails += snapshot[MetricCounter::OFFERS_SENT] == 0 && decode_time.count == 0 ? 0 : 1;
+        fails += decode_time.Quantile(0.5) == 0ns ? 0 : 1;
+    }
+    // Test every bucket of each histogram has a unique bound
+    for (const auto name : {"decode_time", "lock_hold_time", "callback_queue_delay"}) {
+        const auto bucket = "chirp_" + std::string(name) + "_seconds_bucket{le=\"";
+        std::set<std::string> bounds {};
+        std::size_t buckets = 0;
+        for (auto pos = prometheus.find(bucket); pos != std::string::npos; pos = prometheus.find(bucket, pos + 1)) {
+            const auto start = pos + bucket.size();
+            bounds.emplace(prometheus.substr(start, prometheus.find('"', start) - start));
+            ++buckets;
+        }
+        fails += buckets == METRIC_HISTOGRAM_BUCKETS && bounds.size() == buckets ? 0 : 1;
+    }
+
+    // Test that the managers count the handled messages, share receive socket such that both receive each others messages
+    asio::io_context io_context {};
+    Demultiplexer demultiplexer {io_context, "0.0.0.0"};
+    Manager manager1 {demultiplexer, "0.0.0.0", "group1", "sat1"};
+    Manager manager2 {demultiplexer, "0.0.0.0", "group1", "sat2"};
+    manager1.Start();
+    manager2.Start();
+    demultiplexer.Start();
+
+    auto work_guard = asio::make_work_guard(io_context);
+    std::thread io_thread {[&]() { io_context.run(); }};
+
+    manager2.RegisterDiscoverCallback([](DiscoveredService, bool, std::any) {}, DATA, {});
+    manager1.RegisterService(DATA, 50100);
+    std::this_thread::sleep_for(5ms);
+    manager2.SendRequest(DATA);
+    std::this_thread::sleep_for(5ms);
+    const auto snapshot1 = manager1.GetMetricsSnapshot();
+    const auto snapshot2 = manager2.GetMetricsSnapshot();
+    const auto snapshot_demultiplexer = demultiplexer.GetMetricsSnapshot();
+    if constexpr (Metrics::ENABLED) {
+        fails += snapshot1[MetricCounter::REQUESTS_RECEIVED] == 1 ? 0 : 1;
+        fails += snapshot1[MetricCounter::OFFERS_SENT] == 1 ? 0 : 1;
+        fails += snapshot2[MetricCounter::OFFERS_RECEIVED] == 2 ? 0 : 1;
+        fails += snapshot2[MetricCounter::CALLBACKS_DISPATCHED] == 1 ? 0 : 1;
+        fails += snapshot2[MetricHistogram::LOCK_HOLD_TIME].count == 2 ? 0 : 1;
+        fails += snapshot2[MetricHistogram::CALLBACK_QUEUE_DELAY].count == 1 ? 0 : 1;
+        // OFFER, REQUEST and reply OFFER, each dropped by its sender
+        fails += snapshot_demultiplexer[MetricCounter::DATAGRAMS_RECEIVED] >= 3 ? 0 : 1;
+        fails += snapshot_demultiplexer[MetricCounter::DROPPED_SELF] >= 3 ? 0 : 1;
+        fails += snapshot_demultiplexer[MetricHistogram::DECODE_TIME].count >= 3 ? 0 : 1;
+    }
+    else {
+        fails += snapshot2[MetricCounter::OFFERS_RECEIVED] == 0 ? 0 : 1;
+        fails += snapshot_demultiplexer[MetricCounter::DATAGRAMS_RECEIVED] == 0 ? 0 : 1;
+    }
+
+    work_guard.reset();
+    io_context.stop();
+    io_thread.join();
+
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_callback_dispatcher_order() {
+    int fails = 0;
+    constexpr std::size_t keys = 4;
+    constexpr std::size_t tasks = 1000;
+    std::array<std::vector<std::size_t>, keys> executed {};
+    std::atomic_size_t count {0};
+    {
+        CallbackDispatcher dispatcher {4, keys};
+        for (std::size_t n = 0; n < tasks; ++n) {
+            const auto key = n % keys;
+            dispatcher.Dispatch(key, [&, key, n]() {
+                executed.at(key).push_back(n);
+                ++count;
+            });
+        }
+        // Destructor waits for all tasks
+    }
+    fails += count.load() == tasks ? 0 : 1;
+    // Test tasks of the same key are executed in order of dispatch
+    for (const auto& lane : executed) {
+        fails += std::ranges::is_sorted(lane) ? 0 : 1;
+        fails += lane.size() == tasks / keys ? 0 : 1;
+    }
+    return fails;
+}
+
+int test_manager_callback_threads() {
+    int fails = 0;
+    // Test that the default worker pool executes different lanes in parallel
+    std::promise<void> released {};
+    auto released_future = released.get_future();
+    std::atomic_bool waited {false};
+    {
+        CallbackDispatcher dispatcher {};
+        dispatcher.Dispatch(0, [&]() { waited = released_future.wait_for(1s) == std::future_status::ready; });
+        dispatcher.Dispatch(1, [&]() { released.set_value(); });
+        // Destructor waits for both tasks
+    }
+    fails += waited ? 0 : 1;
+    {
+        // Test that callbacks are executed on own threads when the external IO context is not run
+        asio::io_context io_context {};
+        MemoryBus bus {};
+        MemoryTransport transport1 {bus};
+        MemoryTransport transport2 {bus};
+        Manager manager1 {io_context, transport1, "group1", "sat1"};
+        Manager manager2 {io_context, transport2, "group1", "sat2"};
+        fails += manager2.SetCallbackThreads(1) ? 0 : 1;
+        std::atomic_int discovered {0};
+        const auto callback = [](DiscoveredService, bool, std::any user_data) {
+            ++(*std::any_cast<std::atomic_int*>(user_data));
+        };
+        manager2.RegisterDiscoverCallback(callback, CONTROL, &discovered);
+        manager1.Start();
+        manager2.Start();
+        manager1.RegisterService(CONTROL, 23999);
+        bus.Poll();
+        std::this_thread::sleep_for(5ms);
+        fails += discovered == 1 ? 0 : 1;
+        // Test that the dispatcher is not replaced while it is in use
+        fails += manager2.SetCallbackThreads(2) ? 1 : 0;
+    }
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_memory_bus() {
+    int fails = 0;
+    MemoryBus bus {};
+    MemoryTransport transport1 {bus};
+    MemoryTransport transport2 {bus};
+    Manager manager1 {transport1, "group1", "sat1"};
+    Manager manager2 {transport2, "group1", "sat2"};
+    manager1.Start();
+    manager2.Start();
+    // Test that OFFER is delivered when polling the bus
+    manager1.RegisterService(DATA, 50100);
+    fails += manager2.GetDiscoveredServices().empty() ? 0 : 1;
+    bus.Poll();
+    auto services = manager2.GetDiscoveredServices(DATA);
+    fails += services.size() == 1 ? 0 : 1;
+    if (services.size() == 1) {
+        fails += services[0].address == asio::ip::address(transport1.GetAddress()) ? 0 : 1;
+        fails += services[0].port == 50100 ? 0 : 1;
+    }
+    // Test that REQUEST and reply are delivered within a single poll
+    manager2.ForgetDiscoveredServices();
+    manager2.SendRequest(DATA);
+    fails += bus.Poll() == 4 ? 0 : 1;
+    fails += manager2.GetDiscoveredServices(DATA).size() == 1 ? 0 : 1;
+    // Test DEPART
+    manager1.UnregisterService(DATA, 50100);
+    bus.Poll();
+    fails += manager2.GetDiscoveredServices().empty() ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_memory_bus_scale() {
+    int fails = 0;
+    constexpr std::size_t count = 200;
+    // IO context is not run, all messages are handled while polling the bus
+    asio::io_context io_context {};
+    MemoryBus bus {};
+    std::vector<std::unique_ptr<MemoryTransport>> transports {};
+    std::vector<std::unique_ptr<Manager>> managers {};
+    for (std::size_t n = 0; n < count; ++n) {
+        transports.push_back(std::make_unique<MemoryTransport>(bus));
+        managers.push_back(std::make_unique<Manager>(io_context, *transports.back(), "group1", "sat" + std::to_string(n)));
+        managers.back()->Start();
+    }
+    for (std::size_t n = 0; n < count; ++n) {
+        managers[n]->RegisterService(CONTROL, static_cast<Port>(50000 + n));
+    }
+    // Test that every manager discovered all other managers
+    fails += bus.Poll() == count * count ? 0 : 1;
+    for (const auto& manager : managers) {
+        fails += manager->GetDiscoveredServices(CONTROL).size() == count - 1 ? 0 : 1;
+    }
+    for (const auto& transport : transports) {
+        fails += transport->GetDroppedMessages() == 0 ? 0 : 1;
+    }
+    // Managers are destroyed before their transports
+    managers.clear();
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_discovery_cache() {
+    int fails = 0;
+    const auto directory = std::filesystem::temp_directory_path() / "chirp_test_discovery_cache";
+    std::filesystem::remove_all(directory);
+    DiscoveryCache cache {directory, MD5Hash("group1")};
+    // Test that a missing snapshot loads no services
+    fails += cache.Load().empty() ? 0 : 1;
+    // Test store and load of IPv4 and IPv6 services
+    const std::vector<DiscoveredService> services {
+        {asio::ip::make_address("192.168.1.2"), MD5Hash("sat1"), CONTROL, 23999},
+        {asio::ip::make_address("fe80::1"), MD5Hash("sat2"), DATA, 50100},
+    };
+    fails += cache.Store(services) ? 0 : 1;
+    const auto expected_size = DiscoveryCache::HEADER_SIZE + services.size() * DiscoveryCache::RECORD_SIZE;
+    fails += std::filesystem::file_size(cache.GetPath()) == expected_size ? 0 : 1;
+    const auto loaded = cache.Load();
+    fails += loaded.size() == services.size() ? 0 : 1;
+    for (std::size_t n = 0; n < std::min(loaded.size(), services.size()); ++n) {
+        fails += loaded[n].address == services[n].address ? 0 : 1;
+        fails += loaded[n].host_id == services[n].host_id ? 0 : 1;
+        fails += loaded[n].identifier == services[n].identifier ? 0 : 1;
+        fails += loaded[n].port == services[n].port ? 0 : 1;
+    }
+    // Test that snapshots are stored per group
+    DiscoveryCache other_cache {directory, MD5Hash("group2")};
+    fails += other_cache.GetPath() != cache.GetPath() ? 0 : 1;
+    fails += other_cache.Load().empty() ? 0 : 1;
+    // Test that a snapshot of another group is rejected
+    std::filesystem::copy_file(cache.GetPath(), other_cache.GetPath());
+    fails += other_cache.Load().empty() ? 0 : 1;
+    // Test that a truncated snapshot is rejected
+    std::filesystem::resize_file(cache.GetPath(), DiscoveryCache::HEADER_SIZE + DiscoveryCache::RECORD_SIZE + 1);
+    fails += cache.Load().empty() ? 0 : 1;
+    // Test that storing replaces the snapshot
+    fails += cache.Store({services.data(), 1}) ? 0 : 1;
+    fails += cache.Load().size() == 1 ? 0 : 1;
+    std::filesystem::remove_all(directory);
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_discovery_cache_warm_restart() {
+    int fails = 0;
+    const auto directory = std::filesystem::temp_directory_path() / "chirp_test_warm_restart";
+    std::filesystem::remove_all(directory);
+    // IO context is only polled, confirmation timeout does not expire
+    asio::io_context io_context {};
+    MemoryBus bus {};
+    MemoryTransport transport1 {bus};
+    MemoryTransport transport2 {bus};
+    Manager manager1 {io_context, transport1, "group1", "sat1"};
+    manager1.Start();
+    manager1.RegisterService(CONTROL, 23999);
+    {
+        Manager manager2 {io_context, transport2, "group1", "sat2"};
+        manager2.SetDiscoveryCache(directory);
+        manager2.Start();
+        manager2.SendRequest(CONTROL);
+        bus.Poll();
+        fails += manager2.GetDiscoveredServices(CONTROL).size() == 1 ? 0 : 1;
+        // Snapshot is stored on destruction
+    }
+    {
+        Manager manager2 {io_context, transport2, "group1", "sat2"};
+        manager2.SetDiscoveryCache(directory);
+        std::atomic_int discovered {0};
+        const auto callback = [](DiscoveredService, bool depart, std::any user_data) {
+            if (!depart) {
+                ++(*std::any_cast<std::atomic_int*>(user_data));
+            }
+        };
+        manager2.RegisterDiscoverCallback(callback, CONTROL, &discovered);
+        // Test that the cached service is discovered on start before any message is delivered
+        manager2.Start();
+        fails += manager2.GetDiscoveredServices(CONTROL).size() == 1 ? 0 : 1;
+        // Test that a single REQUEST is sent and its reply confirms the service without rediscovering it
+        fails += bus.Poll() == 2 * 2 ? 0 : 1;
+        fails += manager2.GetDiscoveredServices(CONTROL).size() == 1 ? 0 : 1;
+        // Callbacks are dispatched via the IO context
+        io_context.poll();
+        fails += discovered == 1 ? 0 : 1;
+        // Test that confirmed services are stored
+        fails += manager2.StoreDiscoveryCache() ? 0 : 1;
+        fails += DiscoveryCache(directory, MD5Hash("group1")).Load().size() == 1 ? 0 : 1;
+    }
+    {
+        // Snapshot with an outdated address of the service
+        const DiscoveredService moved {asio::ip::make_address("127.0.0.200"), MD5Hash("sat1"), CONTROL, 23999};
+        DiscoveryCache(directory, MD5Hash("group1")).Store({&moved, 1});
+        Manager manager2 {io_context, transport2, "group1", "sat2"};
+        manager2.SetDiscoveryCache(directory);
+        manager2.Start();
+        // Test that the confirming OFFER replaces the address
+        bus.Poll();
+        const auto services = manager2.GetDiscoveredServices(CONTROL);
+        fails += services.size() == 1 ? 0 : 1;
+        if (services.size() == 1) {
+            fails += services[0].address == asio::ip::address(transport1.GetAddress()) ? 0 : 1;
+        }
+    }
+    std::filesystem::remove_all(directory);
+    return fails == 0 ? 0 : 1;
+}
+
+int test_manager_discovery_cache_expiry() {
+    int fails = 0;
+    const auto directory = std::filesystem::temp_directory_path() / "chirp_test_cache_expiry";
+    std::filesystem::remove_all(directory);
+    // Snapshot with a service of a host which is gone
+    DiscoveryCache cache {directory, MD5Hash("group1")};
+    const DiscoveredService gone {asio::ip::make_address("127.0.0.200"), MD5Hash("sat_gone"), CONTROL, 23999};
+    cache.Store({&gone, 1});
+    MemoryBus bus {};
+    MemoryTransport transport {bus};
+    std::atomic_int departed {0};
+    const auto callback = [](DiscoveredService, bool depart, std::any user_data) {
+        if (depart) {
+            ++(*std::any_cast<std::atomic_int*>(user_data));
+        }
+    };
+    {
+        Manager manager {transport, "group1", "sat1"};
+        manager.SetDiscoveryCache(directory, 10ms);
+        manager.RegisterDiscoverCallback(callback, CONTROL, &departed);
+        manager.Start();
+        fails += manager.GetDiscoveredServices(CONTROL).size() == 1 ? 0 : 1;
+        // Test that the unconfirmed service is removed after the confirmation timeout
+        bus.Poll();
+        std::this_thread::sleep_for(50ms);
+        fails += manager.GetDiscoveredServices(CONTROL).empty() ? 0 : 1;
+        fails += departed == 1 ? 0 : 1;
+    }
+    // Test that the expired service is not stored again
+    fails += cache.Load().empty() ? 0 : 1;
+    std::filesystem::remove_all(directory);
+    return fails == 0 ? 0 : 1;
+}
+
 int main() {
     int ret = 0;
     int ret_test = 0;
@@ -344,6 +1461,12 @@ int main() {
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_manager_discovered_service_table
+    std::cout << "test_manager_discovered_service_table...     " << std::flush;
+    ret_test = test_manager_discovered_service_table();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     // test_manager_sort_discover_callback_entry
     std::cout << "test_manager_sort_discover_callback_entry... " << std::flush;
     ret_test = test_manager_sort_discover_callback_entry();
@@ -386,12 +1509,30 @@ int main() {
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_manager_discovery_snapshot
+    std::cout << "test_manager_discovery_snapshot...           " << std::flush;
+    ret_test = test_manager_discovery_snapshot();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     // test_manager_callbacks
     std::cout << "test_manager_callbacks...                    " << std::flush;
     ret_test = test_manager_callbacks();
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_manager_callback_index
+    std::cout << "test_manager_callback_index...               " << std::flush;
+    ret_test = test_manager_callback_index();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_batch_callbacks
+    std::cout << "test_manager_batch_callbacks...              " << std::flush;
+    ret_test = test_manager_batch_callbacks();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     // test_manager_send_request
     std::cout << "test_manager_send_request...                 " << std::flush;
     ret_test = test_manager_send_request();
@@ -404,12 +1545,152 @@ int main() {
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_manager_offer_replay
+    std::cout << "test_manager_offer_replay...                 " << std::flush;
+    ret_test = test_manager_offer_replay();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_reply_scheduling
+    std::cout << "test_manager_reply_scheduling...             " << std::flush;
+    ret_test = test_manager_reply_scheduling();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_reply_after_announcement
+    std::cout << "test_manager_reply_after_announcement...     " << std::flush;
+    ret_test = test_manager_reply_after_announcement();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     // test_manager_decode_error
     std::cout << "test_manager_decode_error...                 " << std::flush;
     ret_test = test_manager_decode_error();
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_manager_shared_io_context
+    std::cout << "test_manager_shared_io_context...            " << std::flush;
+    ret_test = test_manager_shared_io_context();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_shared_demultiplexer
+    std::cout << "test_manager_shared_demultiplexer...         " << std::flush;
+    ret_test = test_manager_shared_demultiplexer();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_kernel_filter
+    std::cout << "test_manager_kernel_filter...                " << std::flush;
+    ret_test = test_manager_kernel_filter();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_dual_stack
+    std::cout << "test_manager_dual_stack...                   " << std::flush;
+    ret_test = test_manager_dual_stack();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_spin_poll
+    std::cout << "test_manager_spin_poll...                    " << std::flush;
+    ret_test = test_manager_spin_poll();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_multicast
+    std::cout << "test_manager_multicast...                    " << std::flush;
+    ret_test = test_manager_multicast();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_duplicate_filter
+    std::cout << "test_manager_duplicate_filter...             " << std::flush;
+    ret_test = test_manager_duplicate_filter();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_timer_wheel
+    std::cout << "test_manager_timer_wheel...                  " << std::flush;
+    ret_test = test_manager_timer_wheel();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_liveness
+    std::cout << "test_manager_liveness...                     " << std::flush;
+    ret_test = test_manager_liveness();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_idle_expiry
+    std::cout << "test_manager_idle_expiry...                  " << std::flush;
+    ret_test = test_manager_idle_expiry();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_async_discover
+    std::cout << "test_manager_async_discover...               " << std::flush;
+    ret_test = test_manager_async_discover();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+#if defined(ASIO_HAS_CO_AWAIT)
+    // test_manager_co_await_discover
+    std::cout << "test_manager_co_await_discover...            " << std::flush;
+    ret_test = test_manager_co_await_discover();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+#endif
+
+    // test_manager_metrics
+    std::cout << "test_manager_metrics...                      " << std::flush;
+    ret_test = test_manager_metrics();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_callback_dispatcher_order
+    std::cout << "test_manager_callback_dispatcher_order...    " << std::flush;
+    ret_test = test_manager_callback_dispatcher_order();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_callback_threads
+    std::cout << "test_manager_callback_threads...             " << std::flush;
+    ret_test = test_manager_callback_threads();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_memory_bus
+    std::cout << "test_manager_memory_bus...                   " << std::flush;
+    ret_test = test_manager_memory_bus();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_memory_bus_scale
+    std::cout << "test_manager_memory_bus_scale...             " << std::flush;
+    ret_test = test_manager_memory_bus_scale();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_discovery_cache
+    std::cout << "test_manager_discovery_cache...              " << std::flush;
+    ret_test = test_manager_discovery_cache();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_discovery_cache_warm_restart
+    std::cout << "test_manager_discovery_cache_warm_restart... " << std::flush;
+    ret_test = test_manager_discovery_cache_warm_restart();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_manager_discovery_cache_expiry
+    std::cout << "test_manager_discovery_cache_expiry...       " << std::flush;
+    ret_test = test_manager_discovery_cache_expiry();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     if (ret == 0) {
         std::cout << "\nAll tests passed" << std::endl;
     }
@@ -1,6 +1,12 @@
+#include <algorithm>
+#include <array>
+#include <compare>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <span>
+#include <tuple>
+#include <string>
 #include <vector>
 
 #include "CHIRP/exceptions.hpp"
@@ -25,6 +31,57 @@ int test_message_md5_sort() {
     int fails = 0;
     fails += MD5Hash("a") < MD5Hash("a") ? 1 : 0;
     fails += MD5Hash("a") < MD5Hash("b") ? 0 : 1;
+    // Test that ordering is lexicographic, i.e. a later smaller byte does not matter
+    MD5Hash lhs {};
+    MD5Hash rhs {};
+    lhs[0] = 0x02;
+    lhs[15] = 0x00;
+    rhs[0] = 0x01;
+    rhs[15] = 0xFF;
+    fails += lhs < rhs ? 1 : 0;
+    fails += rhs < lhs ? 0 : 1;
+    // Test that ordering and equality match byte-wise comparison
+    std::vector<MD5Hash> hashes {};
+    for (int n = 0; n < 100; ++n) {
+        hashes.emplace_back(std::to_string(n));
+    }
+    for (const auto& hash_a : hashes) {
+        for (const auto& hash_b : hashes) {
+            const auto ord = std::lexicographical_compare_three_way(hash_a.begin(), hash_a.end(), hash_b.begin(), hash_b.end());
+            fails += (hash_a <=> hash_b) == ord ? 0 : 1;
+            fails += (hash_a == hash_b) == std::ranges::equal(hash_a, hash_b) ? 0 : 1;
+        }
+    }
+    // Test that comparison is usable in constant expressions
+    static_assert(MD5Hash() == MD5Hash());
+    static_assert(std::is_eq(MD5Hash() <=> MD5Hash()));
+    return fails == 0 ? 0 : 1;
+}
+
+int test_message_md5_constexpr() {
+    using namespace cnstln::CHIRP::literals;
+    int fails = 0;
+    // Test compile-time hashing against runtime hashing, including inputs longer than one block
+    constexpr auto hash_a = "a"_md5;
+    static_assert(hash_a[0] == 0x0c && hash_a[15] == 0x61);
+    fails += hash_a == MD5Hash(std::string("a")) ? 0 : 1;
+    constexpr auto hash_long = "12345678901234567890123456789012345678901234567890123456789012345678901234567890"_md5;
+    fails += hash_long.to_string() == "57edf4a22be3c955ac49da2e2107b67a" ? 0 : 1;
+    // Test interned hashes
+    const auto group_name = std::string("group");
+    fails += MD5Hash::Intern(group_name) == MD5Hash("group") ? 0 : 1;
+    fails += MD5Hash::Intern(group_name) == "group"_md5 ? 0 : 1;
+    fails += MD5Hash::Intern("") == MD5Hash("") ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
+int test_message_builder() {
+    const MessageBuilder builder {MD5Hash("group"), MD5Hash("host")};
+    int fails = 0;
+    // Test that built messages are identical to assembled messages
+    fails += builder.Build(OFFER, CONTROL, 47890) == Message(OFFER, "group", "host", CONTROL, 47890).Assemble() ? 0 : 1;
+    fails += builder.Build(DEPART, DATA, 1) == Message(DEPART, "group", "host", DATA, 1).Assemble() ? 0 : 1;
+    fails += builder.Build(REQUEST, HEARTBEAT, 0) == Message(REQUEST, "group", "host", HEARTBEAT, 0).Assemble() ? 0 : 1;
     return fails == 0 ? 0 : 1;
 }
 
@@ -60,6 +117,22 @@ int test_message_reconstructed() {
     return fails == 0 ? 0 : 1;
 }
 
+int test_message_reconstructed_span() {
+    auto msg = Message(DEPART, "group", "host", MONITORING, 47891);
+    auto asm_msg = msg.Assemble();
+    // Place message inside larger buffer, e.g. a receive buffer
+    std::array<std::uint8_t, CHIRP_MESSAGE_LENGTH + 2> buffer {};
+    std::copy(asm_msg.begin(), asm_msg.end(), buffer.begin() + 1);
+    auto msg_reconstructed = Message(std::span(buffer).subspan<1, CHIRP_MESSAGE_LENGTH>());
+    int fails = 0;
+    fails += msg.GetType() == msg_reconstructed.GetType() ? 0 : 1;
+    fails += msg.GetGroupID() == msg_reconstructed.GetGroupID() ? 0 : 1;
+    fails += msg.GetHostID() == msg_reconstructed.GetHostID() ? 0 : 1;
+    fails += msg.GetServiceIdentifier() == msg_reconstructed.GetServiceIdentifier() ? 0 : 1;
+    fails += msg.GetPort() == msg_reconstructed.GetPort() ? 0 : 1;
+    return fails == 0 ? 0 : 1;
+}
+
 int test_message_construct_invalid_chirpv1() {
     auto msg = Message(REQUEST, "group", "host", HEARTBEAT, 0);
     auto asm_msg = msg.Assemble();
@@ -106,6 +179,61 @@ int test_message_construct_invalid_service() {
     return ret;
 }
 
+int test_message_decode_status() {
+    const auto asm_msg = Message(OFFER, "group", "host", CONTROL, 47890).Assemble();
+    int fails = 0;
+    // Test successful decode
+    const auto result = Message::Decode(asm_msg);
+    fails += result.has_value() ? 0 : 1;
+    fails += result && result->GetPort() == 47890 ? 0 : 1;
+    // Test length
+    fails += Message::Decode(std::span(asm_msg).first(CHIRP_MESSAGE_LENGTH - 1)).error() == DecodeStatus::INVALID_LENGTH ? 0 : 1;
+    // Test header
+    auto asm_msg_invalid = asm_msg;
+    asm_msg_invalid[MessageLayout::VERSION_OFFSET] = '\x02';
+    fails += Message::Decode(asm_msg_invalid).error() == DecodeStatus::INVALID_HEADER ? 0 : 1;
+    // Test message type
+    asm_msg_invalid = asm_msg;
+    asm_msg_invalid[MessageLayout::TYPE_OFFSET] = 0;
+    fails += Message::Decode(asm_msg_invalid).error() == DecodeStatus::INVALID_TYPE ? 0 : 1;
+    // Test service identifier
+    asm_msg_invalid = asm_msg;
+    asm_msg_invalid[MessageLayout::SERVICE_ID_OFFSET] = 5;
+    const auto result_invalid = Message::Decode(asm_msg_invalid);
+    fails += result_invalid.error() == DecodeStatus::INVALID_SERVICE_IDENTIFIER ? 0 : 1;
+    // Test value() throws DecodeError with the same messages as the constructor
+    try {
+        std::ignore = result_invalid.value();
+        fails += 1;
+    }
+    catch (const DecodeError& error) {
+        fails += std::strcmp(error.what(), "Service Identifier invalid") == 0 ? 0 : 1;
+    }
+    return fails == 0 ? 0 : 1;
+}
+
+int test_message_view() {
+    const auto msg = Message(DEPART, "group", "host", DATA, 51234);
+    const auto asm_msg = msg.Assemble();
+    int fails = 0;
+    const auto view = MessageView::Decode(asm_msg);
+    fails += view.has_value() ? 0 : 1;
+    if (view) {
+        fails += view->GetType() == DEPART ? 0 : 1;
+        fails += view->GetGroupID() == msg.GetGroupID() ? 0 : 1;
+        fails += view->GetHostID() == msg.GetHostID() ? 0 : 1;
+        fails += view->GetServiceIdentifier() == DATA ? 0 : 1;
+        fails += view->GetPort() == 51234 ? 0 : 1;
+        fails += view->ToMessage().Assemble() == asm_msg ? 0 : 1;
+    }
+    // Test that the codec is usable at compile time
+    constexpr auto asm_msg_constexpr = Message(REQUEST, MD5Hash(), MD5Hash(), HEARTBEAT, 0x1234).Assemble();
+    static_assert(asm_msg_constexpr[MessageLayout::PORT_OFFSET] == 0x34);
+    static_assert(MessageView::Decode(asm_msg_constexpr)->GetPort() == 0x1234);
+    static_assert(Message::Decode(asm_msg_constexpr)->GetServiceIdentifier() == HEARTBEAT);
+    return fails == 0 ? 0 : 1;
+}
+
 int main() {
     int ret = 0;
     int ret_test = 0;
@@ -122,6 +250,18 @@ int main() {
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_message_md5_constexpr
+    std::cout << "test_message_md5_constexpr...                " << std::flush;
+    ret_test = test_message_md5_constexpr();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_message_builder
+    std::cout << "test_message_builder...                      " << std::flush;
+    ret_test = test_message_builder();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     // test_message_assemble
     std::cout << "test_message_assemble...                    " << std::flush;
     ret_test = test_message_assemble();
@@ -134,6 +274,12 @@ int main() {
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_message_reconstructed_span
+    std::cout << "test_message_reconstructed_span...           " << std::flush;
+    ret_test = test_message_reconstructed_span();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     // test_message_construct_invalid_chirpv1
     std::cout << "test_message_construct_invalid_chirpv1...    " << std::flush;
     ret_test = test_message_construct_invalid_chirpv1();
@@ -152,6 +298,18 @@ int main() {
     std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
     ret += ret_test;
 
+    // test_message_decode_status
+    std::cout << "test_message_decode_status...                " << std::flush;
+    ret_test = test_message_decode_status();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
+    // test_message_view
+    std::cout << "test_message_view...                         " << std::flush;
+    ret_test = test_message_view();
+    std::cout << (ret_test == 0 ? " passed" : " failed") << std::endl;
+    ret += ret_test;
+
     if (ret == 0) {
         std::cout << "\nAll tests passed" << std::endl;
     }